@@ -0,0 +1,456 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+	Kako bazen dijeli zadatke dretvama; bira se pri stvaranju bazena, bez ponovnog prevodjenja.
+	ZajednickiRed: jedan red pod jednim mutexom, svaka dretva uzima s pocetka.
+	KradjaPosla: svaka dretva ima svoj red; zadatak poslan iz dretve bazena ide u njezin red
+	(uzima se s kraja, pa je najsvjezije jos u prirucnoj memoriji), a izvana redom po dretvama.
+	Dretva bez posla krade s pocetka tudjih redova, prvo od dretvi na istom NUMA cvoru.
+*/
+enum class RasporedDretvi
+{
+	ZajednickiRed,
+	KradjaPosla
+};
+
+/* Brojaci jedne dretve od stvaranja bazena ili zadnjeg ResetirajStatistiku */
+struct StatistikaRadnika
+{
+	uint64_t izvrseno = 0, ukradeno = 0, pokusajaKradje = 0;
+	int cpu = -1, cvor = -1;
+};
+
+/*
+	Bazen dretvi: Posalji vraca std::future na rezultat zadatka. Dretve zive koliko i bazen, pa se
+	ne placa stvaranje dretve po zadatku. Uz prikvaci svaka dretva dobiva svoju jezgru, cvor po cvor.
+*/
+class BazenDretvi
+{
+public:
+	explicit BazenDretvi(unsigned brDretvi = 0, RasporedDretvi raspored = RasporedDretvi::ZajednickiRed, bool prikvaci = false)
+		: raspored(raspored)
+	{
+		if (brDretvi == 0)
+			brDretvi = std::max(1u, std::thread::hardware_concurrency());
+		radnici.reset(new Radnik[brDretvi]);
+		if (prikvaci)
+		{
+			std::vector<std::pair<int, int>> procesori = ProcesoriPoCvorovima();
+			for (unsigned i = 0; i < brDretvi && !procesori.empty(); i++)
+			{
+				radnici[i].cpu = procesori[i % procesori.size()].first;
+				radnici[i].cvor = procesori[i % procesori.size()].second;
+			}
+		}
+		for (unsigned i = 0; i < brDretvi; i++)
+		{
+			/* Zrtve kradje: prvo isti cvor, zatim ostale, pocevsi od susjeda da se kradljivci ne gomilaju */
+			for (unsigned k = 1; k < brDretvi; k++)
+				radnici[i].zrtve.push_back((i + k) % brDretvi);
+			std::stable_partition(radnici[i].zrtve.begin(), radnici[i].zrtve.end(),
+				[&](unsigned j) { return radnici[j].cvor == radnici[i].cvor; });
+		}
+		for (unsigned i = 0; i < brDretvi; i++)
+			dretve.emplace_back([this, i] { Petlja(i); });
+	}
+
+	~BazenDretvi()
+	{
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			kraj = true;
+		}
+		cv.notify_all();
+		for (auto& d : dretve)
+			d.join();
+	}
+
+	BazenDretvi(const BazenDretvi&) = delete;
+	BazenDretvi& operator=(const BazenDretvi&) = delete;
+
+	unsigned BrojDretvi() const { return (unsigned)dretve.size(); }
+	RasporedDretvi Raspored() const { return raspored; }
+
+	template <class F>
+	auto Posalji(F f) -> std::future<decltype(f())>
+	{
+		typedef decltype(f()) R;
+		auto zadatak = std::make_shared<std::packaged_task<R()>>(std::move(f));
+		std::future<R> rez = zadatak->get_future();
+		Stavi([zadatak] { (*zadatak)(); });
+		return rez;
+	}
+
+	/*
+		Ceka rezultat; dretva bazena za to vrijeme izvrsava druge zadatke, pa zadatak smije cekati
+		svoje podzadatke bez opasnosti da sve dretve stoje.
+	*/
+	template <class T>
+	T Pricekaj(std::future<T>& f)
+	{
+		PomaziDok([&f] { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+		return f.get();
+	}
+
+	/* Zadatak bez buducnosti (npr. nastavak koji sam javlja rezultat); ne smije baciti iznimku */
+	void Izvrsi(std::function<void()> zadatak) { Stavi(std::move(zadatak)); }
+
+	bool JeDretvaBazena() const { return Trenutni().bazen == this; }
+
+	/* Iz dretve bazena izvrsava druge zadatke dok gotovo() ne vrati true; iz ostalih dretvi ne radi nista */
+	template <class P>
+	void PomaziDok(P gotovo)
+	{
+		if (JeDretvaBazena())
+			while (!gotovo())
+			{
+				std::function<void()> zadatak;
+				if (Uzmi(Trenutni().indeks, zadatak))
+					zadatak();
+				else
+					std::this_thread::yield();
+			}
+	}
+
+	/*
+		f(i) za i iz [0, n) u komadima. Uz komad = 0 velicina se odredjuje sama: pozivatelj obradi
+		prvih nekoliko elemenata u komadima koji se udvostrucuju dok ne prodje PROBA_NS, pa se iz
+		izmjerenog vremena po elementu uzme komad od oko CILJ_KOMADA_NS, ali ne veci od cetvrtine
+		onog sto dolazi na jednu dretvu (da kradja ima sto uravnoteziti).
+	*/
+	template <class F>
+	void Foreach(size_t n, F f, size_t komad = 0)
+	{
+		Komadi(n, komad, [&f](size_t od, size_t doo) {
+			for (size_t i = od; i < doo; i++)
+				f(i);
+		});
+	}
+
+	template <class F>
+	auto Map(size_t n, F f, size_t komad = 0) -> std::vector<decltype(f(size_t()))>
+	{
+		typedef decltype(f(size_t())) R;
+		static_assert(!std::is_same<R, bool>::value, "std::vector<bool> se ne smije puniti iz vise dretvi");
+		std::vector<R> rez(n);
+		Komadi(n, komad, [&](size_t od, size_t doo) {
+			for (size_t i = od; i < doo; i++)
+				rez[i] = f(i);
+		});
+		return rez;
+	}
+
+	/* Komadi se reduciraju zasebno, a zatim redom od pocetka, pa je redoslijed isti svaki put */
+	template <class F, class T, class Op>
+	T MapReduce(size_t n, F f, T pocetna, Op redukcija, size_t komad = 0)
+	{
+		std::vector<std::pair<size_t, T>> djelomicni;
+		std::mutex m;
+		Komadi(n, komad, [&](size_t od, size_t doo) {
+			T r = f(od);
+			for (size_t i = od + 1; i < doo; i++)
+				r = redukcija(r, f(i));
+			std::lock_guard<std::mutex> l(m);
+			djelomicni.emplace_back(od, std::move(r));
+		});
+		std::sort(djelomicni.begin(), djelomicni.end(),
+			[](const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) { return a.first < b.first; });
+		for (auto& d : djelomicni)
+			pocetna = redukcija(pocetna, d.second);
+		return pocetna;
+	}
+
+	/* Komad koji su zadnji Foreach/Map/MapReduce izabrali ili dobili */
+	size_t ZadnjiKomad() const { return zadnjiKomad.load(std::memory_order_relaxed); }
+
+	std::vector<StatistikaRadnika> Statistika() const
+	{
+		std::vector<StatistikaRadnika> s(BrojDretvi());
+		for (unsigned i = 0; i < BrojDretvi(); i++)
+		{
+			s[i].izvrseno = radnici[i].izvrseno.load(std::memory_order_relaxed);
+			s[i].ukradeno = radnici[i].ukradeno.load(std::memory_order_relaxed);
+			s[i].pokusajaKradje = radnici[i].pokusajaKradje.load(std::memory_order_relaxed);
+			s[i].cpu = radnici[i].cpu;
+			s[i].cvor = radnici[i].cvor;
+		}
+		return s;
+	}
+
+	void ResetirajStatistiku()
+	{
+		for (unsigned i = 0; i < BrojDretvi(); i++)
+		{
+			radnici[i].izvrseno.store(0, std::memory_order_relaxed);
+			radnici[i].ukradeno.store(0, std::memory_order_relaxed);
+			radnici[i].pokusajaKradje.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/* (procesor, cvor) za sve procesore koje proces smije koristiti, cvor po cvor */
+	static std::vector<std::pair<int, int>> ProcesoriPoCvorovima()
+	{
+		std::vector<std::pair<int, int>> p;
+#ifdef _WIN32
+		/* Samo prva skupina procesora (do 64), kao i SetThreadAffinityMask */
+		DWORD_PTR maskaProcesa = 0, maskaSustava = 0;
+		GetProcessAffinityMask(GetCurrentProcess(), &maskaProcesa, &maskaSustava);
+		ULONGLONG dopusteni = maskaProcesa;
+		ULONG najveciCvor = 0;
+		if (GetNumaHighestNodeNumber(&najveciCvor))
+			for (ULONG c = 0; c <= najveciCvor; c++)
+			{
+				ULONGLONG maska = 0;
+				if (GetNumaNodeProcessorMask((UCHAR)c, &maska))
+					for (int b = 0; b < (int)sizeof(DWORD_PTR) * 8; b++)
+						if ((maska & dopusteni) >> b & 1)
+							p.push_back({ b, (int)c });
+			}
+		if (p.empty())
+			for (int b = 0; b < (int)sizeof(DWORD_PTR) * 8; b++)
+				if (dopusteni >> b & 1)
+					p.push_back({ b, 0 });
+#else
+		cpu_set_t dopusteni;
+		CPU_ZERO(&dopusteni);
+		sched_getaffinity(0, sizeof(dopusteni), &dopusteni);
+		/* Cvorovi ne moraju biti uzastopni; popis je npr. "0-3,8-11" */
+		for (int c = 0; c < 256; c++)
+		{
+			std::ifstream dat("/sys/devices/system/node/node" + std::to_string(c) + "/cpulist");
+			int od, doo;
+			char znak = ',';
+			while (dat && znak == ',' && dat >> od)
+			{
+				doo = od;
+				znak = 0;
+				if (dat.get(znak) && znak == '-')
+				{
+					dat >> doo;
+					znak = 0;
+					dat.get(znak);
+				}
+				for (int cpu = od; cpu <= doo; cpu++)
+					if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &dopusteni))
+						p.push_back({ cpu, c });
+			}
+		}
+		if (p.empty())
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+				if (CPU_ISSET(cpu, &dopusteni))
+					p.push_back({ cpu, 0 });
+#endif
+		return p;
+	}
+
+	static constexpr long long PROBA_NS = 20000;
+	static constexpr long long CILJ_KOMADA_NS = 100000;
+
+private:
+	struct alignas(64) Radnik
+	{
+		std::mutex mtx;
+		std::deque<std::function<void()>> red;
+		std::atomic<uint64_t> izvrseno{ 0 }, ukradeno{ 0 }, pokusajaKradje{ 0 };
+		int cpu = -1, cvor = -1;
+		std::vector<unsigned> zrtve;
+	};
+
+	struct TrenutniRadnik
+	{
+		const BazenDretvi* bazen = nullptr;
+		unsigned indeks = 0;
+	};
+
+	static TrenutniRadnik& Trenutni()
+	{
+		static thread_local TrenutniRadnik t;
+		return t;
+	}
+
+	static void PrikvaciNa(int cpu)
+	{
+#ifdef _WIN32
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#else
+		cpu_set_t s;
+		CPU_ZERO(&s);
+		CPU_SET(cpu, &s);
+		pthread_setaffinity_np(pthread_self(), sizeof(s), &s);
+#endif
+	}
+
+	void Stavi(std::function<void()> zadatak)
+	{
+		if (raspored == RasporedDretvi::ZajednickiRed)
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			red.push(std::move(zadatak));
+		}
+		else
+		{
+			unsigned i = Trenutni().bazen == this ? Trenutni().indeks : sljedeci.fetch_add(1, std::memory_order_relaxed) % BrojDretvi();
+			{
+				std::lock_guard<std::mutex> l(radnici[i].mtx);
+				radnici[i].red.push_back(std::move(zadatak));
+			}
+			naCekanju.fetch_add(1);
+			/* Prazno zakljucavanje: dretva koja je upravo provjerila naCekanju i ide spavati ne propusta obavijest */
+			std::lock_guard<std::mutex> l(mtx);
+		}
+		cv.notify_one();
+	}
+
+	bool Uzmi(unsigned i, std::function<void()>& zadatak)
+	{
+		Radnik& r = radnici[i];
+		if (raspored == RasporedDretvi::ZajednickiRed)
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			if (red.empty())
+				return false;
+			zadatak = std::move(red.front());
+			red.pop();
+		}
+		else
+		{
+			{
+				std::lock_guard<std::mutex> l(r.mtx);
+				if (!r.red.empty())
+				{
+					zadatak = std::move(r.red.back());
+					r.red.pop_back();
+				}
+			}
+			for (size_t k = 0; !zadatak && k < r.zrtve.size(); k++)
+			{
+				r.pokusajaKradje.fetch_add(1, std::memory_order_relaxed);
+				Radnik& zrtva = radnici[r.zrtve[k]];
+				std::lock_guard<std::mutex> l(zrtva.mtx);
+				if (!zrtva.red.empty())
+				{
+					zadatak = std::move(zrtva.red.front());
+					zrtva.red.pop_front();
+					r.ukradeno.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			if (!zadatak)
+				return false;
+			naCekanju.fetch_sub(1);
+		}
+		r.izvrseno.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/* Pod mtx */
+	bool ImaPosla() const { return raspored == RasporedDretvi::ZajednickiRed ? !red.empty() : naCekanju.load() > 0; }
+
+	void Petlja(unsigned i)
+	{
+		Trenutni().bazen = this;
+		Trenutni().indeks = i;
+		if (radnici[i].cpu >= 0)
+			PrikvaciNa(radnici[i].cpu);
+		for (;;)
+		{
+			std::function<void()> zadatak;
+			if (Uzmi(i, zadatak))
+			{
+				zadatak();
+				continue;
+			}
+			std::unique_lock<std::mutex> l(mtx);
+			cv.wait(l, [this] { return kraj || ImaPosla(); });
+			if (kraj && !ImaPosla())
+				return;
+		}
+	}
+
+	template <class G>
+	void Komadi(size_t n, size_t komad, G obradi)
+	{
+		size_t od = 0;
+		if (komad == 0)
+		{
+			typedef std::chrono::steady_clock Sat;
+			size_t najvise = std::max<size_t>(1, n / (4 * (size_t)BrojDretvi()));
+			auto pocetak = Sat::now();
+			long long ns = 0;
+			for (size_t b = 1; od < n && od < najvise && ns < PROBA_NS; b *= 2)
+			{
+				size_t doo = std::min(n, od + b);
+				obradi(od, doo);
+				od = doo;
+				ns = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(Sat::now() - pocetak).count();
+			}
+			double poElementu = std::max(1.0, (double)ns / std::max<size_t>(1, od));
+			komad = std::max<size_t>(1, std::min((size_t)(CILJ_KOMADA_NS / poElementu), (n - od) / (4 * (size_t)BrojDretvi())));
+		}
+		zadnjiKomad.store(komad, std::memory_order_relaxed);
+		std::vector<std::future<void>> gotovi;
+		while (od < n)
+		{
+			size_t doo = n - od > komad ? od + komad : n;
+			gotovi.push_back(Posalji([&obradi, od, doo] { obradi(od, doo); }));
+			od = doo;
+		}
+		/* Svi komadi moraju zavrsiti prije izlaska jer drze referencu na obradi */
+		std::exception_ptr greska;
+		for (auto& g : gotovi)
+			try
+			{
+				Pricekaj(g);
+			}
+			catch (...)
+			{
+				if (!greska)
+					greska = std::current_exception();
+			}
+		if (greska)
+			std::rethrow_exception(greska);
+	}
+
+	RasporedDretvi raspored;
+	std::unique_ptr<Radnik[]> radnici;
+	std::vector<std::thread> dretve;
+	std::queue<std::function<void()>> red;
+	std::atomic<long long> naCekanju{ 0 };
+	std::atomic<unsigned> sljedeci{ 0 };
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool kraj = false;
+	/* Foreach/Map/MapReduce se smiju zvati iz vise dretvi (i iz zadataka bazena) */
+	std::atomic<size_t> zadnjiKomad{ 0 };
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+/*
+	Generator binomne razdiobe Binomial(n, p) u O(1) po uzorku.
+	Za n*min(p,1-p) >= 30 koristi se BTPE (Kachitvichyanukul & Schmeiser, 1988),
+	a za male n*p obicna inverzija (prosjecno n*p koraka).
+	Sluzi za brzu provjeru: umjesto 10^j parova (x,y) izvlaci se samo broj pogodaka.
+*/
+template <class URNG>
+long long BinomnaBTPE(URNG& gen, long long n, double p)
+{
+	std::uniform_real_distribution<double> U(0.0, 1.0);
+	double r = std::min(p, 1.0 - p);
+	double q = 1.0 - r;
+	long long y = 0;
+
+	if (n * r < 30.0)
+	{
+		/* Inverzija: P(0) = q^n, P(y) = P(y-1) * (n-y+1)/y * r/q */
+		double qn = std::exp(n * std::log(q));
+		double np = n * r;
+		double granica = std::min((double)n, np + 10.0 * std::sqrt(np * q + 1));
+		double u = U(gen), px = qn;
+		while (u > px)
+		{
+			y++;
+			if (y > granica)
+			{
+				y = 0;
+				px = qn;
+				u = U(gen);
+			}
+			else
+			{
+				u -= px;
+				px = ((n - y + 1) * r * px) / (y * q);
+			}
+		}
+		return p > 0.5 ? n - y : y;
+	}
+
+	double nrq = n * r * q;
+	double fm = n * r + r;
+	long long m = (long long)std::floor(fm);
+	double p1 = std::floor(2.195 * std::sqrt(nrq) - 4.6 * q) + 0.5;
+	double xm = m + 0.5, xl = xm - p1, xr = xm + p1;
+	double c = 0.134 + 20.5 / (15.3 + m);
+	double a = (fm - xl) / (fm - xl * r);
+	double laml = a * (1.0 + a / 2.0);
+	a = (xr - fm) / (xr * q);
+	double lamr = a * (1.0 + a / 2.0);
+	double p2 = p1 * (1.0 + 2.0 * c);
+	double p3 = p2 + c / laml;
+	double p4 = p3 + c / lamr;
+
+	/* Stirlingova korekcija za log(x!) */
+	auto st = [](double x) {
+		double x2 = x * x;
+		return (13680. - (462. - (132. - (99. - 140. / x2) / x2) / x2) / x2) / x / 166320.;
+	};
+
+	for (;;)
+	{
+		double u = U(gen) * p4, v = U(gen);
+		if (u <= p1)
+		{
+			/* Trokut oko moda, prihvaca se odmah */
+			y = (long long)std::floor(xm - p1 * v + u);
+			break;
+		}
+		if (u <= p2)
+		{
+			/* Paralelogram */
+			double x = xl + (u - p1) / c;
+			v = v * c + 1.0 - std::fabs(m - x + 0.5) / p1;
+			if (v > 1.0)
+				continue;
+			y = (long long)std::floor(x);
+		}
+		else if (u <= p3)
+		{
+			/* Lijevi eksponencijalni rep */
+			if (v == 0.0)
+				continue;
+			y = (long long)std::floor(xl + std::log(v) / laml);
+			if (y < 0)
+				continue;
+			v = v * (u - p2) * laml;
+		}
+		else
+		{
+			/* Desni eksponencijalni rep */
+			if (v == 0.0)
+				continue;
+			y = (long long)std::floor(xr - std::log(v) / lamr);
+			if (y > n)
+				continue;
+			v = v * (u - p3) * lamr;
+		}
+
+		long long k = std::llabs(y - m);
+		if (k <= 20 || k >= nrq / 2.0 - 1)
+		{
+			/* Izravna usporedba s f(y)/f(m) rekurzijom */
+			double s = r / q, A = s * (n + 1), F = 1.0;
+			if (m < y)
+				for (long long i = m + 1; i <= y; i++)
+					F *= (A / i - s);
+			else if (m > y)
+				for (long long i = y + 1; i <= m; i++)
+					F /= (A / i - s);
+			if (v > F)
+				continue;
+			break;
+		}
+
+		/* Squeeze pa tocna usporedba preko Stirlingove formule */
+		double kd = (double)k;
+		double rho = (kd / nrq) * ((kd * (kd / 3.0 + 0.625) + 0.16666666666666666) / nrq + 0.5);
+		double t = -kd * kd / (2 * nrq);
+		double A = std::log(v);
+		if (A < t - rho)
+			break;
+		if (A > t + rho)
+			continue;
+
+		double x1 = y + 1.0, f1 = m + 1.0, z = n + 1.0 - m, w = n - y + 1.0;
+		double granica = xm * std::log(f1 / x1) + (n - m + 0.5) * std::log(z / w)
+			+ (y - m) * std::log(w * r / (x1 * q)) + st(f1) + st(z) + st(x1) + st(w);
+		if (A > granica)
+			continue;
+		break;
+	}
+	return p > 0.5 ? n - y : y;
+}
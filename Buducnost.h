@@ -0,0 +1,397 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BazenDretvi.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#define BUDUCNOST_KORUTINE 1
+#include <coroutine>
+#endif
+
+/*
+	Buducnost s nastavcima: Then(f) ne blokira dretvu nego f zakaci na stanje, pa se f posalje u
+	bazen tek kad je rezultat gotov. Tako cjevovod (generiraj komad -> reduciraj -> statistika ->
+	zapis) ne drzi blokiranu dretvu po stupnju. KadSvi i KadBiloKoji spajaju vise buducnosti, a uz
+	C++20 korutine Buducnost se moze cekati s co_await i vracati iz korutine.
+
+	Nastavak se izvrsava u bazenu izvorne buducnosti (ili u zadanom), a bez bazena odmah u dretvi
+	koja je javila rezultat. Get vraca referencu na rezultat, pa ista buducnost moze imati vise
+	nastavaka. Iznimka iz zadatka ili nastavka prelazi na sve sljedece buducnosti i baca se iz Get.
+*/
+
+template <class T>
+class Buducnost;
+
+template <class T>
+struct StanjeBuducnosti
+{
+	typedef typename std::conditional<std::is_void<T>::value, char, T>::type Vrijednost;
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool gotovo = false;
+	std::optional<Vrijednost> vrijednost;
+	std::exception_ptr greska;
+	std::vector<std::function<void()>> nastavci;
+	BazenDretvi* bazen = nullptr;
+
+	template <class... A>
+	void Postavi(A&&... a)
+	{
+		std::vector<std::function<void()>> n;
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			vrijednost.emplace(std::forward<A>(a)...);
+			gotovo = true;
+			n.swap(nastavci);
+		}
+		Zavrsi(n);
+	}
+
+	void PostaviGresku(std::exception_ptr e)
+	{
+		std::vector<std::function<void()>> n;
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			greska = e;
+			gotovo = true;
+			n.swap(nastavci);
+		}
+		Zavrsi(n);
+	}
+
+	/* Ako je rezultat vec gotov, f se poziva odmah u ovoj dretvi */
+	void DodajNastavak(std::function<void()> f)
+	{
+		if (!DodajAkoNijeGotovo(f))
+			f();
+	}
+
+	/* Vraca false (i ne zadrzava f) ako je rezultat vec gotov */
+	bool DodajAkoNijeGotovo(std::function<void()>& f)
+	{
+		std::lock_guard<std::mutex> l(mtx);
+		if (gotovo)
+			return false;
+		nastavci.push_back(std::move(f));
+		return true;
+	}
+
+	bool Spremno()
+	{
+		std::lock_guard<std::mutex> l(mtx);
+		return gotovo;
+	}
+
+private:
+	void Zavrsi(std::vector<std::function<void()>>& n)
+	{
+		cv.notify_all();
+		for (auto& f : n)
+			f();
+	}
+};
+
+template <class T>
+struct JeBuducnost : std::false_type
+{
+};
+
+template <class T>
+struct JeBuducnost<Buducnost<T>> : std::true_type
+{
+};
+
+/* Vrijednost ili greska iz izvora prelazi u odrediste */
+template <class T>
+void Proslijedi(StanjeBuducnosti<T>& izvor, StanjeBuducnosti<T>& odrediste)
+{
+	if (izvor.greska)
+		odrediste.PostaviGresku(izvor.greska);
+	else if constexpr (std::is_void<T>::value)
+		odrediste.Postavi();
+	else
+		odrediste.Postavi(*izvor.vrijednost);
+}
+
+template <class T>
+class Buducnost
+{
+public:
+	typedef T Tip;
+
+	Buducnost() = default;
+	explicit Buducnost(std::shared_ptr<StanjeBuducnosti<T>> stanje) : stanje(std::move(stanje)) {}
+
+	bool Valjana() const { return (bool)stanje; }
+	bool Spremno() const { return stanje->Spremno(); }
+
+	/* U dretvi bazena za vrijeme cekanja izvrsava druge zadatke */
+	void Cekaj() const
+	{
+		if (stanje->bazen && stanje->bazen->JeDretvaBazena())
+		{
+			stanje->bazen->PomaziDok([this] { return stanje->Spremno(); });
+			return;
+		}
+		std::unique_lock<std::mutex> l(stanje->mtx);
+		stanje->cv.wait(l, [this] { return stanje->gotovo; });
+	}
+
+	decltype(auto) Get() const
+	{
+		Cekaj();
+		if (stanje->greska)
+			std::rethrow_exception(stanje->greska);
+		if constexpr (!std::is_void<T>::value)
+			return static_cast<const T&>(*stanje->vrijednost);
+	}
+
+	/*
+		f(rezultat) (ili f() za Buducnost<void>) kad rezultat bude gotov, u bazenu gdje ili u bazenu
+		ove buducnosti. Ako f vraca Buducnost<U>, rezultat je Buducnost<U> koja ceka i nju.
+	*/
+	template <class F>
+	auto Then(F f, BazenDretvi* gdje = nullptr)
+	{
+		typedef decltype(Pozovi(f, std::declval<StanjeBuducnosti<T>&>())) R;
+		typedef typename std::conditional<JeBuducnost<R>::value, R, Buducnost<R>>::type Rezultat;
+		typedef typename Rezultat::Tip U;
+		BazenDretvi* bazen = gdje ? gdje : stanje->bazen;
+		auto izvor = stanje;
+		auto sljedece = std::make_shared<StanjeBuducnosti<U>>();
+		sljedece->bazen = bazen;
+		auto posao = [izvor, sljedece, f]() mutable {
+			if (izvor->greska)
+			{
+				sljedece->PostaviGresku(izvor->greska);
+				return;
+			}
+			try
+			{
+				if constexpr (JeBuducnost<R>::value)
+				{
+					auto unutarnje = Pozovi(f, *izvor).stanje;
+					unutarnje->DodajNastavak([unutarnje, sljedece] { Proslijedi(*unutarnje, *sljedece); });
+				}
+				else if constexpr (std::is_void<R>::value)
+				{
+					Pozovi(f, *izvor);
+					sljedece->Postavi();
+				}
+				else
+					sljedece->Postavi(Pozovi(f, *izvor));
+			}
+			catch (...)
+			{
+				sljedece->PostaviGresku(std::current_exception());
+			}
+		};
+		stanje->DodajNastavak([bazen, posao]() mutable {
+			if (bazen)
+				bazen->Izvrsi(posao);
+			else
+				posao();
+		});
+		return Rezultat(sljedece);
+	}
+
+	const std::shared_ptr<StanjeBuducnosti<T>>& Stanje() const { return stanje; }
+
+#ifdef BUDUCNOST_KORUTINE
+	struct promise_type;
+#endif
+
+private:
+	template <class F>
+	static decltype(auto) Pozovi(F& f, StanjeBuducnosti<T>& s)
+	{
+		if constexpr (std::is_void<T>::value)
+			return f();
+		else
+			return f(static_cast<const T&>(*s.vrijednost));
+	}
+
+	template <class>
+	friend class Buducnost;
+
+	std::shared_ptr<StanjeBuducnosti<T>> stanje;
+};
+
+/* Strana koja javlja rezultat; Postavi ili PostaviGresku smije se pozvati samo jednom */
+template <class T>
+class Obecanje
+{
+public:
+	explicit Obecanje(BazenDretvi* bazen = nullptr) : stanje(std::make_shared<StanjeBuducnosti<T>>()) { stanje->bazen = bazen; }
+
+	Buducnost<T> Dohvati() const { return Buducnost<T>(stanje); }
+
+	template <class... A>
+	void Postavi(A&&... a) const { stanje->Postavi(std::forward<A>(a)...); }
+
+	void PostaviGresku(std::exception_ptr e) const { stanje->PostaviGresku(e); }
+
+private:
+	std::shared_ptr<StanjeBuducnosti<T>> stanje;
+};
+
+/* f() u bazenu; nastavci rezultata takodjer idu u taj bazen */
+template <class F>
+auto Asinkrono(BazenDretvi& bazen, F f) -> Buducnost<decltype(f())>
+{
+	typedef decltype(f()) R;
+	Obecanje<R> obecanje(&bazen);
+	bazen.Izvrsi([obecanje, f]() mutable {
+		try
+		{
+			if constexpr (std::is_void<R>::value)
+			{
+				f();
+				obecanje.Postavi();
+			}
+			else
+				obecanje.Postavi(f());
+		}
+		catch (...)
+		{
+			obecanje.PostaviGresku(std::current_exception());
+		}
+	});
+	return obecanje.Dohvati();
+}
+
+/*
+	Gotova kad su gotove sve ulazne; greska prve (po redu) neuspjele ulazne prelazi na rezultat.
+	Bez zadanog bazena nastavci rezultata idu u bazen prve ulazne (isto i za KadBiloKoji).
+*/
+template <class T>
+auto KadSvi(const std::vector<Buducnost<T>>& ulazi, BazenDretvi* bazen = nullptr)
+{
+	typedef typename std::conditional<std::is_void<T>::value, void, std::vector<T>>::type R;
+	Obecanje<R> obecanje(bazen || ulazi.empty() ? bazen : ulazi[0].Stanje()->bazen);
+	if (ulazi.empty())
+	{
+		obecanje.Postavi();
+		return obecanje.Dohvati();
+	}
+	auto preostalo = std::make_shared<std::atomic<size_t>>(ulazi.size());
+	auto kopije = std::make_shared<std::vector<Buducnost<T>>>(ulazi);
+	for (const Buducnost<T>& u : ulazi)
+		u.Stanje()->DodajNastavak([preostalo, kopije, obecanje] {
+			if (preostalo->fetch_sub(1) != 1)
+				return;
+			for (const Buducnost<T>& k : *kopije)
+				if (k.Stanje()->greska)
+				{
+					obecanje.PostaviGresku(k.Stanje()->greska);
+					return;
+				}
+			if constexpr (std::is_void<T>::value)
+				obecanje.Postavi();
+			else
+			{
+				std::vector<T> v;
+				v.reserve(kopije->size());
+				for (const Buducnost<T>& k : *kopije)
+					v.push_back(*k.Stanje()->vrijednost);
+				obecanje.Postavi(std::move(v));
+			}
+		});
+	return obecanje.Dohvati();
+}
+
+/* Indeks prve gotove ulazne buducnosti (gotova i ako je javila gresku); baca std::invalid_argument za prazan popis */
+template <class T>
+Buducnost<size_t> KadBiloKoji(const std::vector<Buducnost<T>>& ulazi, BazenDretvi* bazen = nullptr)
+{
+	if (ulazi.empty())
+		throw std::invalid_argument("KadBiloKoji bez buducnosti");
+	Obecanje<size_t> obecanje(bazen ? bazen : ulazi[0].Stanje()->bazen);
+	auto prvi = std::make_shared<std::atomic<bool>>(false);
+	for (size_t i = 0; i < ulazi.size(); i++)
+		ulazi[i].Stanje()->DodajNastavak([prvi, obecanje, i] {
+			if (!prvi->exchange(true))
+				obecanje.Postavi(i);
+		});
+	return obecanje.Dohvati();
+}
+
+#ifdef BUDUCNOST_KORUTINE
+/*
+	co_await buducnost: korutina se nastavlja u bazenu buducnosti (bez bazena u dretvi koja je javila
+	rezultat), a ne drzi dretvu za vrijeme cekanja.
+*/
+template <class T>
+struct CekanjeBuducnosti
+{
+	Buducnost<T> b;
+
+	bool await_ready() const { return b.Spremno(); }
+
+	/* Ako je rezultat stigao u medjuvremenu, korutina se ne suspendira */
+	bool await_suspend(std::coroutine_handle<> h)
+	{
+		BazenDretvi* bazen = b.Stanje()->bazen;
+		std::function<void()> nastavak = [bazen, h] {
+			if (bazen)
+				bazen->Izvrsi([h] { h.resume(); });
+			else
+				h.resume();
+		};
+		return b.Stanje()->DodajAkoNijeGotovo(nastavak);
+	}
+
+	T await_resume()
+	{
+		if constexpr (std::is_void<T>::value)
+			b.Get();
+		else
+			return b.Get();
+	}
+};
+
+template <class T>
+CekanjeBuducnosti<T> operator co_await(Buducnost<T> b)
+{
+	return CekanjeBuducnosti<T>{ std::move(b) };
+}
+
+/* Korutina koja vraca Buducnost<T> pocinje odmah u dretvi pozivatelja, a co_return javlja rezultat */
+template <class T>
+struct ObecanjeKorutine
+{
+	std::shared_ptr<StanjeBuducnosti<T>> stanje = std::make_shared<StanjeBuducnosti<T>>();
+
+	template <class V>
+	void return_value(V&& v) { stanje->Postavi(std::forward<V>(v)); }
+};
+
+template <>
+struct ObecanjeKorutine<void>
+{
+	std::shared_ptr<StanjeBuducnosti<void>> stanje = std::make_shared<StanjeBuducnosti<void>>();
+
+	void return_void() { stanje->Postavi(); }
+};
+
+template <class T>
+struct Buducnost<T>::promise_type : ObecanjeKorutine<T>
+{
+	Buducnost<T> get_return_object() { return Buducnost<T>(this->stanje); }
+	std::suspend_never initial_suspend() noexcept { return {}; }
+	std::suspend_never final_suspend() noexcept { return {}; }
+	void unhandled_exception() { this->stanje->PostaviGresku(std::current_exception()); }
+};
+#endif
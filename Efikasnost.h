@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Statistika.h"
+
+/*
+	Efikasnost po binovima: broj uspjeha (npr. tocaka u krugu) od ukupnog broja pokusa.
+	Brojevi se dodaju izravno (DodajBrojeve), bez punjenja dogadjaj po dogadjaj, i drze se u 64 bita,
+	pa i 10^10 pokusa po binu stane bez gubitka. Efikasnosti iz vise dretvi zbrajaju se s Dodaj().
+
+	Intervali povjerenja (Clopper-Pearson, Wilson, Bayes s beta priorom) racunaju se pri prvom
+	upitu i pamte po binu, metodi i razini; ponovno se racunaju tek kad se brojevi bina promijene,
+	pa je ponovljeni upit samo usporedba i citanje.
+*/
+
+enum class MetodaIntervala : uint8_t
+{
+	ClopperPearson = 0,
+	Wilson = 1,
+	Bayes = 2
+};
+
+struct Interval
+{
+	double donja, gornja;
+};
+
+class Efikasnost
+{
+public:
+	static const int BR_METODA = 3;
+
+	explicit Efikasnost(int brBinova) : binovi(brBinova) {}
+
+	int BrojBinova() const { return (int)binovi.size(); }
+
+	void DodajBrojeve(int bin, uint64_t prosli, uint64_t ukupno)
+	{
+		Bin& b = binovi[bin];
+		b.prosli += prosli;
+		b.ukupno += ukupno;
+		b.verzija++;
+	}
+
+	void Fill(bool prosao, int bin) { DodajBrojeve(bin, prosao ? 1 : 0, 1); }
+
+	/* Zbraja brojeve iz efikasnosti s istim binovima, npr. iz druge dretve; baca std::runtime_error za drukcije binove */
+	void Dodaj(const Efikasnost& e)
+	{
+		if (e.BrojBinova() != BrojBinova())
+			throw std::runtime_error("Efikasnosti imaju razlicit broj binova");
+		for (size_t i = 0; i < binovi.size(); i++)
+			if (e.binovi[i].ukupno > 0)
+				DodajBrojeve((int)i, e.binovi[i].prosli, e.binovi[i].ukupno);
+	}
+
+	/* Prior Beta(alfa, beta) za Bayesov interval; zadano je jednoliki Beta(1, 1), a Jeffreysov je Beta(0.5, 0.5) */
+	void PostaviPrior(double alfa, double beta)
+	{
+		priorAlfa = alfa;
+		priorBeta = beta;
+		for (Bin& b : binovi)
+			b.verzija++;
+	}
+
+	uint64_t Prosli(int bin) const { return binovi[bin].prosli; }
+	uint64_t Ukupno(int bin) const { return binovi[bin].ukupno; }
+	double Omjer(int bin) const { return binovi[bin].ukupno ? (double)binovi[bin].prosli / binovi[bin].ukupno : 0.0; }
+
+	/* Sredisnji interval s vjerojatnoscu razina (zadano 1 sigma) */
+	Interval IntervalPovjerenja(int bin, MetodaIntervala metoda, double razina = 0.682689492137086)
+	{
+		Bin& b = binovi[bin];
+		Spremljeni& s = b.spremljeni[(int)metoda];
+		if (s.verzija != b.verzija || s.razina != razina)
+		{
+			s.interval = Izracunaj(b.prosli, b.ukupno, metoda, razina);
+			s.verzija = b.verzija;
+			s.razina = razina;
+			brIzracuna++;
+		}
+		return s.interval;
+	}
+
+	/* Koliko je intervala stvarno izracunato (ostali upiti su dosli iz spremljenih) */
+	uint64_t BrojIzracuna() const { return brIzracuna; }
+
+private:
+	struct Spremljeni
+	{
+		uint64_t verzija = UINT64_MAX;
+		double razina = 0.0;
+		Interval interval = { 0.0, 1.0 };
+	};
+
+	struct Bin
+	{
+		uint64_t prosli = 0, ukupno = 0, verzija = 0;
+		Spremljeni spremljeni[BR_METODA];
+	};
+
+	Interval Izracunaj(uint64_t prosli, uint64_t ukupno, MetodaIntervala metoda, double razina) const
+	{
+		double k = (double)prosli, n = (double)ukupno;
+		double alfa = (1.0 - razina) / 2.0;
+		if (ukupno == 0)
+			return { 0.0, 1.0 };
+		if (metoda == MetodaIntervala::ClopperPearson)
+			return { prosli == 0 ? 0.0 : BetaKvantil(k, n - k + 1.0, alfa),
+				prosli == ukupno ? 1.0 : BetaKvantil(k + 1.0, n - k, 1.0 - alfa) };
+		if (metoda == MetodaIntervala::Wilson)
+		{
+			double z = NormalniKvantil(1.0 - alfa), p = k / n;
+			double sredina = (p + z * z / (2.0 * n)) / (1.0 + z * z / n);
+			double pola = z / (1.0 + z * z / n) * sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n));
+			return { std::max(0.0, sredina - pola), std::min(1.0, sredina + pola) };
+		}
+		double a = k + priorAlfa, b = n - k + priorBeta;
+		return { BetaKvantil(a, b, alfa), BetaKvantil(a, b, 1.0 - alfa) };
+	}
+
+	std::vector<Bin> binovi;
+	double priorAlfa = 1.0, priorBeta = 1.0;
+	uint64_t brIzracuna = 0;
+};
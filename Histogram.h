@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "SkupInstrukcija.h"
+
+/*
+	Bin 1..brBinova za x u [xMin, xMin + brBinova / invSirina), 0 za podljev i brBinova+1 za preljev i NaN.
+	Bez grananja, pa ista formula radi i u vektoriziranoj petlji.
+*/
+inline int BinJednakeSirine(double x, double xMin, double invSirina, int brBinova)
+{
+	double t = (x - xMin) * invSirina;
+	t = t < brBinova ? t : brBinova;
+	t = t >= 0.0 ? t : -1.0;
+	return (int)t + 1;
+}
+
+/*
+	Histogram s binovima jednake sirine na [min, max). Bin 0 je podljev, brBinova+1 preljev
+	(NaN ide u preljev). Uz sadrzaj se vode suma tezina, suma kvadrata tezina po binu te
+	sume w*x i w*x^2 za srednju vrijednost i standardnu devijaciju neovisno o binovima.
+
+	FillN puni cijeli niz u komadima: prvo se SIMD instrukcijama (SSE2 ili AVX2, odabir pri
+	izvodjenju) izracunaju indeksi binova i zbroje momenti, a zatim se sadrzaj zbraja
+	u TRAKA zasebnih kopija histograma (element i ide u kopiju i % TRAKA).
+	Uzastopni elementi u istom binu tako ne cekaju jedan na drugoga kroz memoriju;
+	kopije se zbrajaju na kraju poziva.
+*/
+class Histogram1D
+{
+public:
+	static const size_t TRAKA = 4;
+	static const size_t KOMAD = 512;
+
+	Histogram1D(int brBinova, double min, double max)
+		: brBinova(brBinova), xMin(min), xMax(max), invSirina(brBinova / (max - min)),
+		sadrzaj(brBinova + 2, 0.0), sumw2(brBinova + 2, 0.0)
+	{
+	}
+
+	int BrojBinova() const { return brBinova; }
+	double Min() const { return xMin; }
+	double Max() const { return xMax; }
+	double SredinaBina(int bin) const { return xMin + (bin - 0.5) / invSirina; }
+
+	int NadjiBin(double x) const { return BinJednakeSirine(x, xMin, invSirina, brBinova); }
+
+	void Fill(double x, double w = 1.0)
+	{
+		int bin = NadjiBin(x);
+		sadrzaj[bin] += w;
+		sumw2[bin] += w * w;
+		if (bin > 0 && bin <= brBinova)
+			DodajMomente(w, w * w, w * x, w * x * x);
+		brUnosa++;
+	}
+
+	/* Puni n vrijednosti x s tezinama w (nullptr znaci tezinu 1); isti rezultat kao n poziva Fill */
+	void FillN(const double* x, size_t n, const double* w = nullptr)
+	{
+		if (n < KOMAD)
+		{
+			for (size_t i = 0; i < n; i++)
+				Fill(x[i], w ? w[i] : 1.0);
+			return;
+		}
+		if (w)
+			PuniNiz<true>(x, n, w);
+		else
+			PuniNiz<false>(x, n, w);
+		brUnosa += n;
+	}
+
+	double Sadrzaj(int bin) const { return sadrzaj[bin]; }
+	double Greska(int bin) const { return sqrt(sumw2[bin]); }
+	uint64_t BrojUnosa() const { return brUnosa; }
+	double SumaTezina() const { return sumw; }
+	double EfektivniBrojUnosa() const { return sumw2Uk > 0 ? sumw * sumw / sumw2Uk : 0.0; }
+	double SrednjaVrijednost() const { return sumw > 0 ? sumwx / sumw : 0.0; }
+
+	double StDev() const
+	{
+		if (sumw <= 0)
+			return 0.0;
+		double m = sumwx / sumw;
+		return sqrt(std::max(0.0, sumwx2 / sumw - m * m));
+	}
+
+	/* Zbraja drugi histogram s istim binovima (npr. iz druge dretve) */
+	void Dodaj(const Histogram1D& h)
+	{
+		for (size_t b = 0; b < sadrzaj.size(); b++)
+		{
+			sadrzaj[b] += h.sadrzaj[b];
+			sumw2[b] += h.sumw2[b];
+		}
+		DodajMomente(h.sumw, h.sumw2Uk, h.sumwx, h.sumwx2);
+		brUnosa += h.brUnosa;
+	}
+
+private:
+	template <bool TEZINE>
+	void PuniNiz(const double* x, size_t n, const double* w)
+	{
+		size_t korak = brBinova + 2;
+		std::vector<double> trake(TRAKA * korak, 0.0), trake2(TEZINE ? TRAKA * korak : 0, 0.0);
+		double s[TRAKA] = {}, s2[TRAKA] = {}, sx[TRAKA] = {}, sx2[TRAKA] = {};
+		int bin[KOMAD];
+		for (size_t od = 0; od < n; od += KOMAD)
+		{
+			size_t m = std::min(n - od, (size_t)KOMAD);
+			const double* xk = x + od;
+			const double* wk = TEZINE ? w + od : nullptr;
+
+			IndeksiIMomenti<TEZINE>(xk, wk, m, bin, s, s2, sx, sx2);
+
+			/* Sadrzaj po trakama: element i ide u traku i % TRAKA */
+			size_t i = 0;
+			for (; i + TRAKA <= m; i += TRAKA)
+				for (size_t t = 0; t < TRAKA; t++)
+				{
+					size_t k = t * korak + bin[i + t];
+					if (TEZINE)
+					{
+						trake[k] += wk[i + t];
+						trake2[k] += wk[i + t] * wk[i + t];
+					}
+					else
+						trake[k] += 1.0;
+				}
+			for (; i < m; i++)
+			{
+				trake[bin[i]] += TEZINE ? wk[i] : 1.0;
+				if (TEZINE)
+					trake2[bin[i]] += wk[i] * wk[i];
+			}
+		}
+
+		for (size_t t = 0; t < TRAKA; t++)
+		{
+			DodajMomente(s[t], s2[t], sx[t], sx2[t]);
+			for (size_t b = 0; b < korak; b++)
+			{
+				sadrzaj[b] += trake[t * korak + b];
+				sumw2[b] += TEZINE ? trake2[t * korak + b] : trake[t * korak + b];
+			}
+		}
+	}
+
+	/*
+		Indeksi binova za m vrijednosti i momenti unutar raspona (w, w^2, w*x, w*x^2) u TRAKA akumulatora.
+		Vrijednosti izvan raspona se maskiraju prije mnozenja, pa NaN i beskonacnosti ne kvare sume.
+		Granice se racunaju istom formulom kao u NadjiBin, pa svaki put daje iste binove:
+		minpd vraca drugi operand za NaN, kao i usporedba t < brBinova.
+	*/
+	template <bool TEZINE>
+	void IndeksiIMomenti(const double* x, const double* w, size_t m, int* bin, double* s, double* s2, double* sx, double* sx2) const
+	{
+		size_t i = 0;
+#ifdef PI2TEST_X86
+		if (NajboljiSkupInstrukcija() == SkupInstrukcija::AVX2)
+			i = IndeksiAVX2<TEZINE>(x, w, m, bin, s, s2, sx, sx2);
+		else
+			i = IndeksiSSE2<TEZINE>(x, w, m, bin, s, s2, sx, sx2);
+#endif
+		for (; i < m; i++)
+		{
+			double xi = x[i], wi = TEZINE ? w[i] : 1.0;
+			int b = NadjiBin(xi);
+			bin[i] = b;
+			bool unutra = (unsigned)(b - 1) < (unsigned)brBinova;
+			double wu = unutra ? wi : 0.0, xu = unutra ? xi : 0.0;
+			s[i % TRAKA] += wu;
+			s2[i % TRAKA] += wu * wi;
+			sx[i % TRAKA] += wu * xu;
+			sx2[i % TRAKA] += wu * xu * xu;
+		}
+	}
+
+#ifdef PI2TEST_X86
+	/* Dvije vrijednosti po registru, dva registra po koraku (trake 0-1 i 2-3); vraca broj obradjenih */
+	template <bool TEZINE>
+	size_t IndeksiSSE2(const double* x, const double* w, size_t m, int* bin, double* s, double* s2, double* sx, double* sx2) const
+	{
+		const __m128d vMin = _mm_set1_pd(xMin), vInv = _mm_set1_pd(invSirina), vBr = _mm_set1_pd((double)brBinova);
+		const __m128d nula = _mm_setzero_pd(), minus1 = _mm_set1_pd(-1.0), jedan = _mm_set1_pd(1.0);
+		const __m128i jedanI = _mm_set1_epi32(1);
+		__m128d as[2] = { nula, nula }, as2[2] = { nula, nula }, asx[2] = { nula, nula }, asx2[2] = { nula, nula };
+		size_t i = 0;
+		for (; i + 4 <= m; i += 4)
+			for (int h = 0; h < 2; h++)
+			{
+				__m128d vx = _mm_loadu_pd(x + i + 2 * h);
+				__m128d vw = TEZINE ? _mm_loadu_pd(w + i + 2 * h) : jedan;
+				__m128d t = _mm_min_pd(_mm_mul_pd(_mm_sub_pd(vx, vMin), vInv), vBr);
+				__m128d nenegativan = _mm_cmpge_pd(t, nula);
+				t = _mm_or_pd(_mm_and_pd(nenegativan, t), _mm_andnot_pd(nenegativan, minus1));
+				__m128i b = _mm_add_epi32(_mm_cvttpd_epi32(t), jedanI);
+				_mm_storel_epi64((__m128i*)(bin + i + 2 * h), b);
+				__m128d unutra = _mm_and_pd(nenegativan, _mm_cmplt_pd(t, vBr));
+				__m128d wu = _mm_and_pd(unutra, vw), xu = _mm_and_pd(unutra, vx);
+				__m128d wux = _mm_mul_pd(wu, xu);
+				as[h] = _mm_add_pd(as[h], wu);
+				as2[h] = _mm_add_pd(as2[h], _mm_mul_pd(wu, vw));
+				asx[h] = _mm_add_pd(asx[h], wux);
+				asx2[h] = _mm_add_pd(asx2[h], _mm_mul_pd(wux, xu));
+			}
+		double r[2];
+		for (int h = 0; h < 2; h++)
+		{
+			_mm_storeu_pd(r, as[h]); s[2 * h] += r[0]; s[2 * h + 1] += r[1];
+			_mm_storeu_pd(r, as2[h]); s2[2 * h] += r[0]; s2[2 * h + 1] += r[1];
+			_mm_storeu_pd(r, asx[h]); sx[2 * h] += r[0]; sx[2 * h + 1] += r[1];
+			_mm_storeu_pd(r, asx2[h]); sx2[2 * h] += r[0]; sx2[2 * h + 1] += r[1];
+		}
+		return i;
+	}
+
+	/* Cetiri vrijednosti po registru, po jedna u svakoj traci */
+	template <bool TEZINE>
+	PI2TEST_CILJ("avx2")
+	size_t IndeksiAVX2(const double* x, const double* w, size_t m, int* bin, double* s, double* s2, double* sx, double* sx2) const
+	{
+		const __m256d vMin = _mm256_set1_pd(xMin), vInv = _mm256_set1_pd(invSirina), vBr = _mm256_set1_pd((double)brBinova);
+		const __m256d nula = _mm256_setzero_pd(), minus1 = _mm256_set1_pd(-1.0), jedan = _mm256_set1_pd(1.0);
+		const __m128i jedanI = _mm_set1_epi32(1);
+		__m256d as = nula, as2 = nula, asx = nula, asx2 = nula;
+		size_t i = 0;
+		for (; i + 4 <= m; i += 4)
+		{
+			__m256d vx = _mm256_loadu_pd(x + i);
+			__m256d vw = TEZINE ? _mm256_loadu_pd(w + i) : jedan;
+			__m256d t = _mm256_min_pd(_mm256_mul_pd(_mm256_sub_pd(vx, vMin), vInv), vBr);
+			__m256d nenegativan = _mm256_cmp_pd(t, nula, _CMP_GE_OQ);
+			t = _mm256_blendv_pd(minus1, t, nenegativan);
+			_mm_storeu_si128((__m128i*)(bin + i), _mm_add_epi32(_mm256_cvttpd_epi32(t), jedanI));
+			__m256d unutra = _mm256_and_pd(nenegativan, _mm256_cmp_pd(t, vBr, _CMP_LT_OQ));
+			__m256d wu = _mm256_and_pd(unutra, vw), xu = _mm256_and_pd(unutra, vx);
+			__m256d wux = _mm256_mul_pd(wu, xu);
+			as = _mm256_add_pd(as, wu);
+			as2 = _mm256_add_pd(as2, _mm256_mul_pd(wu, vw));
+			asx = _mm256_add_pd(asx, wux);
+			asx2 = _mm256_add_pd(asx2, _mm256_mul_pd(wux, xu));
+		}
+		double r[4];
+		_mm256_storeu_pd(r, as); for (int t = 0; t < 4; t++) s[t] += r[t];
+		_mm256_storeu_pd(r, as2); for (int t = 0; t < 4; t++) s2[t] += r[t];
+		_mm256_storeu_pd(r, asx); for (int t = 0; t < 4; t++) sx[t] += r[t];
+		_mm256_storeu_pd(r, asx2); for (int t = 0; t < 4; t++) sx2[t] += r[t];
+		return i;
+	}
+#endif
+
+	void DodajMomente(double w, double w2, double wx, double wx2)
+	{
+		sumw += w;
+		sumw2Uk += w2;
+		sumwx += wx;
+		sumwx2 += wx2;
+	}
+
+	int brBinova;
+	double xMin, xMax, invSirina;
+	std::vector<double> sadrzaj, sumw2;
+	double sumw = 0.0, sumw2Uk = 0.0, sumwx = 0.0, sumwx2 = 0.0;
+	uint64_t brUnosa = 0;
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Histogram.h"
+
+/*
+	Rijetki visedimenzionalni histogram, npr. po (ponavljanje, eksponent, dretva, procjenitelj, \pi).
+	Pamte se samo popunjeni binovi. Koordinate bina (ukljucujuci podljev i preljev svake osi)
+	pakiraju se u jedan 64-bitni kljuc, a kljucevi stoje u tablici s otvorenim adresiranjem
+	i linearnim probanjem. Kljucevi su u zasebnom nizu (8 u jednoj liniji prirucne memorije),
+	pa probanje cita uzastopne kljuceve, a sadrzaj se dira tek kad se bin nadje.
+	Po binu to je 16 bajtova (24 uz sumw2) pri popunjenosti tablice do 70%.
+
+	FillN racuna kljuceve i pocetna mjesta za komad vrijednosti, dohvaca ta mjesta unaprijed
+	i tek onda umece. Za punjenje iz vise dretvi svaka dretva puni svoj histogram, a na kraju
+	se zbrajaju s Dodaj().
+*/
+class HistogramRijetki
+{
+public:
+	struct Os
+	{
+		int brBinova;
+		double min, max;
+	};
+
+	static const size_t KOMAD = 256;
+
+	explicit HistogramRijetki(const std::vector<Os>& osi, bool sumw2 = false) : osi(osi), imaSumw2(sumw2)
+	{
+		int ukupnoBita = 0;
+		for (const Os& o : osi)
+		{
+			int bita = 1;
+			while ((1ull << bita) < (uint64_t)o.brBinova + 2)
+				bita++;
+			pomak.push_back(ukupnoBita);
+			bitaOsi.push_back(bita);
+			invSirina.push_back(o.brBinova / (o.max - o.min));
+			ukupnoBita += bita;
+		}
+		if (osi.empty() || ukupnoBita > 63)
+			throw std::runtime_error("Koordinate bina rijetkog histograma ne stanu u 63 bita");
+		Pripremi(64);
+	}
+
+	size_t BrojOsi() const { return osi.size(); }
+	const Os& Osa(size_t d) const { return osi[d]; }
+
+	/* x ima BrojOsi() koordinata */
+	void Fill(const double* x, double w = 1.0)
+	{
+		Zbroji(Kljuc(x), w);
+		brUnosa++;
+	}
+
+	/* n tocaka, koordinate redom (x[i * BrojOsi() + d]); w == nullptr znaci tezinu 1 */
+	void FillN(const double* x, size_t n, const double* w = nullptr)
+	{
+		uint64_t kljucevi[KOMAD];
+		size_t dim = osi.size();
+		for (size_t od = 0; od < n; od += KOMAD)
+		{
+			size_t m = std::min(n - od, (size_t)KOMAD);
+			for (size_t i = 0; i < m; i++)
+				kljucevi[i] = Kljuc(x + (od + i) * dim);
+			/* Tablica raste najvise za jedan komad, pa se prije dohvacanja unaprijed osigura mjesto */
+			while ((brPopunjenih + m) * 10 > kljuc.size() * 7)
+				Pripremi(2 * kljuc.size());
+#ifdef PI2TEST_X86
+			for (size_t i = 0; i < m; i++)
+				_mm_prefetch((const char*)&kljuc[Mjesto(kljucevi[i])], _MM_HINT_T0);
+#endif
+			for (size_t i = 0; i < m; i++)
+				Zbroji(kljucevi[i], w ? w[od + i] : 1.0);
+		}
+		brUnosa += n;
+	}
+
+	/* Sadrzaj bina s koordinatama binovi (0 = podljev, brBinova+1 = preljev) */
+	double Sadrzaj(const int* binovi) const
+	{
+		size_t i = Nadji(SlozKljuc(binovi));
+		return i == NEMA ? 0.0 : sumw[i];
+	}
+
+	double Greska(const int* binovi) const
+	{
+		size_t i = Nadji(SlozKljuc(binovi));
+		return i == NEMA ? 0.0 : sqrt(imaSumw2 ? sumw2[i] : sumw[i]);
+	}
+
+	/* f(binovi, sumw, sumw2) za svaki popunjeni bin, redom tablice */
+	template <class F>
+	void ZaSvakiBin(F f) const
+	{
+		std::vector<int> binovi(osi.size());
+		for (size_t i = 0; i < kljuc.size(); i++)
+			if (kljuc[i] != PRAZNO)
+			{
+				for (size_t d = 0; d < osi.size(); d++)
+					binovi[d] = (int)((kljuc[i] >> pomak[d]) & ((1ull << bitaOsi[d]) - 1));
+				f(binovi.data(), sumw[i], imaSumw2 ? sumw2[i] : sumw[i]);
+			}
+	}
+
+	/* Zbraja histogram s istim osima, npr. iz druge dretve; baca std::runtime_error za drukcije osi */
+	void Dodaj(const HistogramRijetki& h)
+	{
+		bool isteOsi = h.osi.size() == osi.size();
+		for (size_t d = 0; isteOsi && d < osi.size(); d++)
+			isteOsi = h.osi[d].brBinova == osi[d].brBinova && h.osi[d].min == osi[d].min && h.osi[d].max == osi[d].max;
+		if (!isteOsi)
+			throw std::runtime_error("Rijetki histogrami imaju razlicite osi");
+		while ((brPopunjenih + h.brPopunjenih) * 10 > kljuc.size() * 7)
+			Pripremi(2 * kljuc.size());
+		for (size_t i = 0; i < h.kljuc.size(); i++)
+			if (h.kljuc[i] != PRAZNO)
+			{
+				size_t j = Umetni(h.kljuc[i]);
+				sumw[j] += h.sumw[i];
+				if (imaSumw2)
+					sumw2[j] += h.imaSumw2 ? h.sumw2[i] : h.sumw[i];
+			}
+		brUnosa += h.brUnosa;
+	}
+
+	size_t BrojPopunjenih() const { return brPopunjenih; }
+	uint64_t BrojUnosa() const { return brUnosa; }
+	size_t BajtovaMemorije() const { return kljuc.size() * (sizeof(uint64_t) + sizeof(double) * (imaSumw2 ? 2 : 1)); }
+
+private:
+	static const uint64_t PRAZNO = std::numeric_limits<uint64_t>::max();
+	static const size_t NEMA = std::numeric_limits<size_t>::max();
+
+	uint64_t Kljuc(const double* x) const
+	{
+		uint64_t k = 0;
+		for (size_t d = 0; d < osi.size(); d++)
+			k |= (uint64_t)BinJednakeSirine(x[d], osi[d].min, invSirina[d], osi[d].brBinova) << pomak[d];
+		return k;
+	}
+
+	uint64_t SlozKljuc(const int* binovi) const
+	{
+		uint64_t k = 0;
+		for (size_t d = 0; d < osi.size(); d++)
+			k |= (uint64_t)binovi[d] << pomak[d];
+		return k;
+	}
+
+	/* Fibonaccijevo rasprsivanje: gornji bitovi umnoska */
+	size_t Mjesto(uint64_t k) const { return (size_t)((k * 0x9E3779B97F4A7C15ull) >> pomakTablice); }
+
+	size_t Nadji(uint64_t k) const
+	{
+		for (size_t i = Mjesto(k);; i = (i + 1) & maska)
+		{
+			if (kljuc[i] == k)
+				return i;
+			if (kljuc[i] == PRAZNO)
+				return NEMA;
+		}
+	}
+
+	size_t Umetni(uint64_t k)
+	{
+		size_t i = Mjesto(k);
+		while (kljuc[i] != k && kljuc[i] != PRAZNO)
+			i = (i + 1) & maska;
+		if (kljuc[i] == PRAZNO)
+		{
+			kljuc[i] = k;
+			brPopunjenih++;
+		}
+		return i;
+	}
+
+	void Zbroji(uint64_t k, double w)
+	{
+		if ((brPopunjenih + 1) * 10 > kljuc.size() * 7)
+			Pripremi(2 * kljuc.size());
+		size_t i = Umetni(k);
+		sumw[i] += w;
+		if (imaSumw2)
+			sumw2[i] += w * w;
+	}
+
+	/* Nova tablica velicine velicina (potencija od 2) i premjestanje postojecih binova */
+	void Pripremi(size_t velicina)
+	{
+		std::vector<uint64_t> stariKljuc;
+		std::vector<double> stariSumw, stariSumw2;
+		stariKljuc.swap(kljuc);
+		stariSumw.swap(sumw);
+		stariSumw2.swap(sumw2);
+
+		kljuc.assign(velicina, (uint64_t)PRAZNO);
+		sumw.assign(velicina, 0.0);
+		if (imaSumw2)
+			sumw2.assign(velicina, 0.0);
+		maska = velicina - 1;
+		pomakTablice = 64;
+		while (((size_t)1 << (64 - pomakTablice)) < velicina)
+			pomakTablice--;
+		brPopunjenih = 0;
+		for (size_t i = 0; i < stariKljuc.size(); i++)
+			if (stariKljuc[i] != PRAZNO)
+			{
+				size_t j = Umetni(stariKljuc[i]);
+				sumw[j] = stariSumw[i];
+				if (imaSumw2)
+					sumw2[j] = stariSumw2[i];
+			}
+	}
+
+	std::vector<Os> osi;
+	std::vector<int> pomak, bitaOsi;
+	std::vector<double> invSirina;
+	bool imaSumw2;
+
+	std::vector<uint64_t> kljuc;
+	std::vector<double> sumw, sumw2;
+	size_t maska = 0, brPopunjenih = 0;
+	int pomakTablice = 64;
+	uint64_t brUnosa = 0;
+};
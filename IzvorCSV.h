@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BazenDretvi.h"
+#include "IzvorPodataka.h"
+#include "StupcanaDatoteka.h"
+
+/*
+	Brojcani CSV kao izvor podataka, za velike datoteke koje generiraju drugi programi.
+	Datoteka se mapira u memoriju i dijeli na komade koji zavrsavaju na kraju reda; redovi u komadima
+	broje se paralelno (istim prolazom odredjuju se i tipovi stupaca), pa je svaki komad jedan raspon
+	redova koji dretva obradjuje sama. Polja se citaju izravno iz mapirane datoteke, bez std::string:
+	osam znamenki odjednom (SWAR), a double s najvise 19 znamenki i eksponentom do 22 racuna se tocno
+	jednim mnozenjem ili dijeljenjem; ostalo ide u std::from_chars.
+
+	Stupci su int64 ili double: stupac je double ako ijedan red u njemu ima polje s '.', 'e' ili
+	slovom. Prazno polje je NaN u double stupcu, a 0 u int64 stupcu. Prazni redovi (i redovi samo
+	s razmacima) preskacu se i ne broje. Navodnici i tekstualni stupci nisu podrzani.
+*/
+
+/* Jesu li svih 8 bajtova (procitanih kao little-endian broj) znamenke '0'-'9' */
+inline bool OsamZnamenki(uint64_t v)
+{
+	return ((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+/* Vrijednost 8 znamenki: parovi, pa cetvorke, pa osmica, svaki korak jednim mnozenjem */
+inline uint32_t VrijednostOsamZnamenki(uint64_t v)
+{
+	v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+	v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+	return (uint32_t)(((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+}
+
+/* Dodaje znamenke od p na m (m*10 + z) i broji ih; preko 19 znamenki m nije tocan i pozivatelj to mora provjeriti */
+inline const char* CitajZnamenke(const char* p, const char* kraj, uint64_t& m, int& brZnamenki)
+{
+	static const bool malo = [] {
+		uint32_t x = 1;
+		uint8_t b;
+		std::memcpy(&b, &x, 1);
+		return b == 1;
+	}();
+	if (malo)
+		while (kraj - p >= 8)
+		{
+			uint64_t v;
+			std::memcpy(&v, p, 8);
+			if (!OsamZnamenki(v))
+				break;
+			m = m * 100000000 + VrijednostOsamZnamenki(v);
+			brZnamenki += 8;
+			p += 8;
+		}
+	while (p < kraj && (unsigned)(*p - '0') < 10)
+	{
+		m = m * 10 + (uint64_t)(*p - '0');
+		brZnamenki++;
+		p++;
+	}
+	return p;
+}
+
+/* Cijeli broj od p; vraca kraj broja ili nullptr ako na p nema broja */
+inline const char* CitajCijeli(const char* p, const char* kraj, int64_t& v)
+{
+	const char* pocetak = p;
+	bool neg = false;
+	if (p < kraj && (*p == '-' || *p == '+'))
+		neg = *p++ == '-';
+	uint64_t m = 0;
+	int br = 0;
+	const char* q = CitajZnamenke(p, kraj, m, br);
+	if (br > 0 && br <= 18)
+	{
+		v = neg ? -(int64_t)m : (int64_t)m;
+		return q;
+	}
+	if (pocetak < kraj && *pocetak == '+')
+		pocetak++;
+	std::from_chars_result r = std::from_chars(pocetak, kraj, v);
+	return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+/* Realni broj od p; vraca kraj broja ili nullptr ako na p nema broja */
+inline const char* CitajDouble(const char* p, const char* kraj, double& v)
+{
+	static const double POT10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const char* pocetak = p;
+	bool neg = false;
+	if (p < kraj && (*p == '-' || *p == '+'))
+		neg = *p++ == '-';
+	uint64_t m = 0;
+	int brCijelih = 0, brDecimala = 0, eksp = 0;
+	p = CitajZnamenke(p, kraj, m, brCijelih);
+	if (p < kraj && *p == '.')
+		p = CitajZnamenke(p + 1, kraj, m, brDecimala);
+	bool brzo = brCijelih + brDecimala > 0 && brCijelih + brDecimala <= 19 && m <= (1ull << 53);
+	if (brzo && p < kraj && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		bool eNeg = false;
+		if (q < kraj && (*q == '-' || *q == '+'))
+			eNeg = *q++ == '-';
+		uint64_t e = 0;
+		int brE = 0;
+		q = CitajZnamenke(q, kraj, e, brE);
+		brzo = brE > 0 && brE <= 4;
+		eksp = eNeg ? -(int)e : (int)e;
+		p = q;
+	}
+	eksp -= brDecimala;
+	if (brzo && eksp >= -22 && eksp <= 22)
+	{
+		double d = (double)m;
+		d = eksp < 0 ? d / POT10[-eksp] : d * POT10[eksp];
+		v = neg ? -d : d;
+		return p;
+	}
+	if (pocetak < kraj && *pocetak == '+')
+		pocetak++;
+	std::from_chars_result r = std::from_chars(pocetak, kraj, v);
+	if (r.ec == std::errc::result_out_of_range)
+		v = std::strtod(std::string(pocetak, r.ptr).c_str(), nullptr); /* +-inf ili 0, kao strtod */
+	else if (r.ec != std::errc())
+		return nullptr;
+	return r.ptr;
+}
+
+class IzvorCSV : public IzvorPodataka
+{
+public:
+	/* Redovi se broje u bazenu dretvi; razdjelnik je znak izmedju polja, a prvi red su imena stupaca */
+	IzvorCSV(const std::string& ime, BazenDretvi& bazen, char razdjelnik = ',') : mapa(ime), razdjelnik(razdjelnik)
+	{
+		pocetak = (const char*)mapa.Podaci();
+		kraj = pocetak + mapa.Velicina();
+		Podijeli(CitajZaglavlje(pocetak), bazen);
+	}
+
+	uint64_t BrojRedova() const { return komadi.empty() ? 0 : komadi.back().prviRed + komadi.back().brRedova; }
+	size_t BrojKomada() const { return komadi.size(); }
+
+	std::vector<std::string> ImenaStupaca() const override { return imena; }
+
+	TipStupca Tip(const std::string& ime) const override { return tipovi[Indeks(ime)]; }
+
+	void PostaviBrojUtora(unsigned brUtora) override
+	{
+		utori = std::vector<Utor>(brUtora);
+		for (Utor& u : utori)
+		{
+			u.vrijednosti.resize(imena.size());
+			for (size_t s = 0; s < imena.size(); s++)
+				u.pokazivaci.push_back(&u.vrijednosti[s]);
+		}
+	}
+
+	const void* const* CitacStupca(const std::string& ime, unsigned utor) override { return &utori[utor].pokazivaci[Indeks(ime)]; }
+
+	std::vector<std::pair<uint64_t, uint64_t>> RasponiRedova() const override
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> r;
+		for (const Komad& k : komadi)
+			if (k.brRedova > 0)
+				r.push_back({ k.prviRed, k.prviRed + k.brRedova });
+		return r;
+	}
+
+	void PocniRaspon(unsigned utor, uint64_t od) override
+	{
+		size_t k = std::upper_bound(komadi.begin(), komadi.end(), od, [](uint64_t r, const Komad& k) { return r < k.prviRed; }) - komadi.begin() - 1;
+		Utor& u = utori[utor];
+		u.komad = k;
+		u.kursor = komadi[k].od;
+		u.sljedeci = komadi[k].prviRed;
+	}
+
+	/* Redovi raspona citaju se redom; preskoceni redovi samo se prolaze do kraja reda */
+	void PostaviRed(unsigned utor, uint64_t red) override
+	{
+		Utor& u = utori[utor];
+		const Komad& k = komadi[u.komad];
+		if (red < u.sljedeci)
+		{
+			u.kursor = k.od;
+			u.sljedeci = k.prviRed;
+		}
+		for (; u.sljedeci < red; u.sljedeci++)
+		{
+			u.kursor = PreskociPrazne(u.kursor, k.doo);
+			const char* nl = (const char*)std::memchr(u.kursor, '\n', k.doo - u.kursor);
+			u.kursor = nl ? nl + 1 : k.doo;
+		}
+		u.kursor = CitajRed(PreskociPrazne(u.kursor, k.doo), k.doo, u.vrijednosti.data(), red);
+		u.sljedeci++;
+	}
+
+private:
+	union Vrijednost
+	{
+		double d;
+		int64_t i;
+	};
+
+	struct Komad
+	{
+		const char *od, *doo;
+		uint64_t prviRed, brRedova;
+	};
+
+	/* Stanje dretve koja obradjuje komad; poravnato na liniju prirucne memorije da se utori ne dijele */
+	struct alignas(64) Utor
+	{
+		const char* kursor = nullptr;
+		uint64_t sljedeci = 0;
+		size_t komad = 0;
+		std::vector<Vrijednost> vrijednosti;
+		std::vector<const void*> pokazivaci;
+	};
+
+	size_t Indeks(const std::string& ime) const
+	{
+		for (size_t s = 0; s < imena.size(); s++)
+			if (imena[s] == ime)
+				return s;
+		throw std::runtime_error("Nema stupca " + ime);
+	}
+
+	static bool Razmak(char c) { return c == ' ' || c == '\t'; }
+
+	/* Pomice p preko redova koji imaju samo razmake (ili nista) */
+	static const char* PreskociPrazne(const char* p, const char* kr)
+	{
+		for (;;)
+		{
+			const char* q = p;
+			while (q < kr && (Razmak(*q) || *q == '\r'))
+				q++;
+			if (q == kr)
+				return q;
+			if (*q != '\n')
+				return p;
+			p = q + 1;
+		}
+	}
+
+	const char* KrajReda(const char* p) const
+	{
+		const char* nl = (const char*)std::memchr(p, '\n', kraj - p);
+		return nl ? nl : kraj;
+	}
+
+	const char* CitajZaglavlje(const char* p)
+	{
+		const char* kr = KrajReda(p);
+		while (p < kr)
+		{
+			const char* d = std::find(p, kr, razdjelnik);
+			const char *a = p, *b = d;
+			while (a < b && (Razmak(*a) || *a == '"'))
+				a++;
+			while (b > a && (Razmak(b[-1]) || b[-1] == '"' || b[-1] == '\r'))
+				b--;
+			imena.push_back(std::string(a, b));
+			p = d < kr ? d + 1 : kr;
+		}
+		if (imena.empty())
+			throw std::runtime_error("CSV datoteka nema zaglavlje");
+		return kr < kraj ? kr + 1 : kraj;
+	}
+
+	/* Redovi komada koji nisu prazni i stupci u kojima neki od njih ima realan broj */
+	struct PregledKomada
+	{
+		uint64_t brRedova = 0;
+		std::vector<char> realni;
+	};
+
+	PregledKomada Pregledaj(const Komad& k) const
+	{
+		PregledKomada r;
+		r.realni.assign(imena.size(), 0);
+		size_t brRealnih = 0;
+		for (const char* p = PreskociPrazne(k.od, k.doo); p < k.doo; p = PreskociPrazne(p, k.doo))
+		{
+			const char* nl = (const char*)std::memchr(p, '\n', k.doo - p);
+			const char* kr = nl ? nl : k.doo;
+			r.brRedova++;
+			/* Kad su svi stupci vec realni, redovi se samo broje */
+			for (size_t s = 0; p < kr && brRealnih < imena.size(); p++)
+				if (*p == razdjelnik)
+					s++;
+				else if (s < imena.size() && !r.realni[s] && (*p == '.' || std::isalpha((unsigned char)*p)))
+				{
+					r.realni[s] = 1;
+					brRealnih++;
+				}
+			p = nl ? nl + 1 : k.doo;
+		}
+		return r;
+	}
+
+	/* Komadi od oko velicinaKomada bajtova koji zavrsavaju iza '\n'; redovi u njima broje se paralelno */
+	void Podijeli(const char* p, BazenDretvi& bazen)
+	{
+		size_t podataka = kraj - p;
+		size_t velicinaKomada = std::min<size_t>(std::max<size_t>(podataka / (bazen.BrojDretvi() * 8 + 1), 1 << 20), 64 << 20);
+		while (p < kraj)
+		{
+			const char* d = p + std::min(velicinaKomada, (size_t)(kraj - p));
+			if (d < kraj)
+			{
+				const char* nl = (const char*)std::memchr(d, '\n', kraj - d);
+				d = nl ? nl + 1 : kraj;
+			}
+			komadi.push_back({ p, d, 0, 0 });
+			p = d;
+		}
+		std::vector<std::future<PregledKomada>> pregledi;
+		for (const Komad& k : komadi)
+			pregledi.push_back(bazen.Posalji([this, k] { return Pregledaj(k); }));
+		/* Bez ijednog reda podataka svi su stupci double */
+		std::vector<char> realni(imena.size(), 0);
+		uint64_t red = 0;
+		for (size_t i = 0; i < komadi.size(); i++)
+		{
+			PregledKomada r = pregledi[i].get();
+			komadi[i].prviRed = red;
+			komadi[i].brRedova = r.brRedova;
+			red += r.brRedova;
+			for (size_t s = 0; s < imena.size(); s++)
+				realni[s] |= r.realni[s];
+		}
+		for (size_t s = 0; s < imena.size(); s++)
+			tipovi.push_back(realni[s] || red == 0 ? TipStupca::Double : TipStupca::Int64);
+	}
+
+	const char* CitajRed(const char* p, const char* kr, Vrijednost* v, uint64_t red) const
+	{
+		for (size_t s = 0; s < imena.size(); s++)
+		{
+			while (p < kr && Razmak(*p))
+				p++;
+			if (p == kr || *p == razdjelnik || *p == '\n' || *p == '\r')
+			{
+				if (tipovi[s] == TipStupca::Double)
+					v[s].d = std::numeric_limits<double>::quiet_NaN();
+				else
+					v[s].i = 0;
+			}
+			else
+			{
+				p = tipovi[s] == TipStupca::Double ? CitajDouble(p, kr, v[s].d) : CitajCijeli(p, kr, v[s].i);
+				if (!p)
+					Greska(red, s);
+				while (p < kr && Razmak(*p))
+					p++;
+			}
+			if (s + 1 < imena.size())
+			{
+				if (p == kr || *p != razdjelnik)
+					Greska(red, s);
+				p++;
+			}
+		}
+		if (p < kr && *p == '\r')
+			p++;
+		if (p < kr && *p++ != '\n')
+			Greska(red, imena.size() - 1);
+		return p;
+	}
+
+	[[noreturn]] void Greska(uint64_t red, size_t s) const
+	{
+		throw std::runtime_error("Neispravno polje " + imena[s] + " u redu " + std::to_string(red + 1) + " CSV datoteke");
+	}
+
+	MapiranaDatoteka mapa;
+	char razdjelnik;
+	const char *pocetak = nullptr, *kraj = nullptr;
+	std::vector<std::string> imena;
+	std::vector<TipStupca> tipovi;
+	std::vector<Komad> komadi;
+	std::vector<Utor> utori;
+};
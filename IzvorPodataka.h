@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "BazenDretvi.h"
+#include "Rezultati.h"
+
+/*
+	Izvor podataka za obradu po redovima iz vise dretvi (po uzoru na RDataSource).
+	Svaka dretva koja obradjuje raspon redova dobije utor 0..brUtora-1; izvor za svaki utor
+	i stupac drzi pokazivac na trenutnu vrijednost, a PostaviRed ga pomakne na zadani red.
+	Korisnik stupca jednom uzme adresu tog pokazivaca (CitacStupca) i cita kroz nju.
+*/
+class IzvorPodataka
+{
+public:
+	virtual ~IzvorPodataka() {}
+
+	virtual std::vector<std::string> ImenaStupaca() const = 0;
+	virtual TipStupca Tip(const std::string& ime) const = 0;
+
+	/* Poziva se prije CitacStupca i obrade */
+	virtual void PostaviBrojUtora(unsigned brUtora) = 0;
+
+	/* Adresa pokazivaca na trenutnu vrijednost stupca u utoru */
+	virtual const void* const* CitacStupca(const std::string& ime, unsigned utor) = 0;
+
+	/* Rasponi redova [od, do) koji se mogu obradjivati neovisno */
+	virtual std::vector<std::pair<uint64_t, uint64_t>> RasponiRedova() const = 0;
+
+	virtual void PocniRaspon(unsigned utor, uint64_t od) { (void)utor; (void)od; }
+	virtual void PostaviRed(unsigned utor, uint64_t red) = 0;
+	virtual void ZavrsiRaspon(unsigned utor) { (void)utor; }
+
+	/*
+		Koliko uzastopnih redova raspona lezi jedan iza drugog u memoriji: nakon PostaviRed(utor, red)
+		pokazivaci stupaca vrijede kao nizovi do toliko redova (ali ne preko kraja raspona).
+		Izvor koji red po red puni jednu vrijednost vraca 1.
+	*/
+	virtual size_t NajveciBlok() const { return 1; }
+};
+
+template <class T>
+const T* const* CitacStupca(IzvorPodataka& izvor, const std::string& ime, unsigned utor)
+{
+	return (const T* const*)izvor.CitacStupca(ime, utor);
+}
+
+/*
+	Stog slobodnih utora pod mutexom, kao RSlotStack; ostaje za usporedbu sa SkupUtora.
+	Zadatak koji obradjuje raspon uzme utor i vrati ga kad zavrsi, pa istovremeni zadaci
+	nikad ne dijele utor.
+*/
+class StogUtora
+{
+public:
+	explicit StogUtora(unsigned brUtora)
+	{
+		for (unsigned u = brUtora; u > 0; u--)
+			slobodni.push_back(u - 1);
+	}
+
+	unsigned Uzmi()
+	{
+		std::lock_guard<std::mutex> l(mtx);
+		if (slobodni.empty())
+			throw std::runtime_error("Nema slobodnog utora");
+		unsigned u = slobodni.back();
+		slobodni.pop_back();
+		return u;
+	}
+
+	void Vrati(unsigned utor)
+	{
+		std::lock_guard<std::mutex> l(mtx);
+		slobodni.push_back(utor);
+	}
+
+private:
+	std::mutex mtx;
+	std::vector<unsigned> slobodni;
+};
+
+inline int NajnizaJedinica(uint64_t x)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	if (_BitScanForward(&i, (unsigned long)x))
+		return (int)i;
+	_BitScanForward(&i, (unsigned long)(x >> 32));
+	return 32 + (int)i;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+/*
+	Skup slobodnih utora bez zakljucavanja: bit po utoru, 1 = slobodan, u 64-bitnim rijecima
+	od kojih je svaka u svojoj liniji prirucne memorije. Dretva prvo pokusa utor koji je zadnji
+	vratila (fetch_and samo tog bita, bez petlje), pa u pravilu uvijek dobije isti utor i njegove
+	podatke u svojoj prirucnoj memoriji; inace uzme najnizi slobodni bit s compare_exchange.
+	Vrati je jedan fetch_or.
+*/
+class SkupUtora
+{
+public:
+	explicit SkupUtora(unsigned brUtora) : brUtora(brUtora), rijeci((brUtora + 63) / 64)
+	{
+		for (unsigned r = 0; r < rijeci.size(); r++)
+		{
+			unsigned u = std::min(64u, brUtora - 64 * r);
+			rijeci[r].bitovi.store(u == 64 ? ~0ull : (1ull << u) - 1, std::memory_order_relaxed);
+		}
+	}
+
+	unsigned Uzmi()
+	{
+		unsigned& zadnji = ZadnjiUtor();
+		if (zadnji < brUtora)
+		{
+			uint64_t bit = 1ull << (zadnji % 64);
+			if (rijeci[zadnji / 64].bitovi.fetch_and(~bit, std::memory_order_acquire) & bit)
+				return zadnji;
+		}
+		for (size_t r = 0; r < rijeci.size(); r++)
+		{
+			std::atomic<uint64_t>& b = rijeci[r].bitovi;
+			uint64_t v = b.load(std::memory_order_relaxed);
+			while (v != 0)
+			{
+				uint64_t bit = v & (0 - v);
+				if (b.compare_exchange_weak(v, v & ~bit, std::memory_order_acquire, std::memory_order_relaxed))
+					return zadnji = (unsigned)(64 * r + NajnizaJedinica(bit));
+			}
+		}
+		throw std::runtime_error("Nema slobodnog utora");
+	}
+
+	void Vrati(unsigned utor) { rijeci[utor / 64].bitovi.fetch_or(1ull << (utor % 64), std::memory_order_release); }
+
+private:
+	struct alignas(64) Rijec
+	{
+		std::atomic<uint64_t> bitovi{ 0 };
+	};
+
+	/* Zadnji utor dretve; ako dretva koristi vise skupova, to je samo savjet koji se provjerava bitom */
+	static unsigned& ZadnjiUtor()
+	{
+		static thread_local unsigned zadnji = ~0u;
+		return zadnji;
+	}
+
+	unsigned brUtora;
+	std::vector<Rijec> rijeci;
+};
+
+/* Svaki raspon je jedan zadatak u bazenu; zadatak drzi utor od PocniRaspon do ZavrsiRaspon */
+template <class F>
+void ObradiRaspone(IzvorPodataka& izvor, BazenDretvi& bazen, unsigned brUtora, F f)
+{
+	SkupUtora utori(brUtora);
+	std::vector<std::future<void>> gotovi;
+	for (const auto& raspon : izvor.RasponiRedova())
+		gotovi.push_back(bazen.Posalji([&izvor, &utori, &f, raspon] {
+			unsigned utor = utori.Uzmi();
+			try
+			{
+				izvor.PocniRaspon(utor, raspon.first);
+				f(utor, raspon.first, raspon.second);
+				izvor.ZavrsiRaspon(utor);
+			}
+			catch (...)
+			{
+				utori.Vrati(utor);
+				throw;
+			}
+			utori.Vrati(utor);
+		}));
+	/* Svi zadaci moraju zavrsiti prije izlaska jer drze reference na utori, f i izvor */
+	std::exception_ptr greska;
+	for (auto& g : gotovi)
+		try
+		{
+			g.get();
+		}
+		catch (...)
+		{
+			if (!greska)
+				greska = std::current_exception();
+		}
+	if (greska)
+		std::rethrow_exception(greska);
+}
+
+/*
+	Obrada svih redova izvora u bazenu dretvi: f(utor, red) se poziva za svaki red.
+	Podaci koje f skuplja drze se po utoru i spajaju nakon povratka.
+*/
+template <class F>
+void ObradiIzvor(IzvorPodataka& izvor, BazenDretvi& bazen, unsigned brUtora, F f)
+{
+	ObradiRaspone(izvor, bazen, brUtora, [&izvor, &f](unsigned utor, uint64_t od, uint64_t doo) {
+		for (uint64_t red = od; red < doo; red++)
+		{
+			izvor.PostaviRed(utor, red);
+			f(utor, red);
+		}
+	});
+}
+
+/*
+	Obrada u blokovima: f(utor, od, n) dobiva n <= velicinaBloka uzastopnih redova, a pokazivaci
+	stupaca utora su nizovi od n vrijednosti. Tijelo je obicna petlja po nizovima koju prevoditelj
+	moze vektorizirati, umjesto poziva po redu. Za izvor s NajveciBlok() == 1 blok je jedan red.
+*/
+template <class F>
+void ObradiIzvorBlokovima(IzvorPodataka& izvor, BazenDretvi& bazen, unsigned brUtora, F f, size_t velicinaBloka = 1024)
+{
+	size_t blok = std::max<size_t>(1, std::min(velicinaBloka, izvor.NajveciBlok()));
+	ObradiRaspone(izvor, bazen, brUtora, [&izvor, &f, blok](unsigned utor, uint64_t od, uint64_t doo) {
+		for (uint64_t red = od; red < doo; red += blok)
+		{
+			izvor.PostaviRed(utor, red);
+			f(utor, red, (size_t)std::min<uint64_t>(blok, doo - red));
+		}
+	});
+}
+
+/*
+	Maska odabira za blok: filtri je sve redom suzavaju (1 = red prolazi), bez grananja po redu,
+	pa se i filtar i brojanje vektoriziraju.
+*/
+class MaskaBloka
+{
+public:
+	void Pocni(size_t n)
+	{
+		this->n = n;
+		maska.assign(n, 1);
+	}
+
+	/* p(i) za red i bloka */
+	template <class P>
+	void Filtriraj(P p)
+	{
+		uint8_t* m = maska.data();
+		for (size_t i = 0; i < n; i++)
+			m[i] &= (uint8_t)(p(i) ? 1 : 0);
+	}
+
+	size_t Broj() const
+	{
+		size_t br = 0;
+		for (size_t i = 0; i < n; i++)
+			br += maska[i];
+		return br;
+	}
+
+	const uint8_t* Podaci() const { return maska.data(); }
+	size_t Velicina() const { return n; }
+
+private:
+	size_t n = 0;
+	std::vector<uint8_t> maska;
+};
+
+/* Stupci u memoriji (npr. vec izracunati) kao izvor; pokazivaci su izravno u vektore */
+class IzvorMemorije : public IzvorPodataka
+{
+public:
+	explicit IzvorMemorije(uint64_t velicinaRaspona = 65536) : velicinaRaspona(std::max<uint64_t>(1, velicinaRaspona)) {}
+
+	/* Vektor mora zivjeti dok traje obrada; svi stupci imaju isti broj redova */
+	void Stupac(const std::string& ime, const std::vector<double>& v) { Dodaj(ime, TipStupca::Double, v.data(), v.size()); }
+	void Stupac(const std::string& ime, const std::vector<int64_t>& v) { Dodaj(ime, TipStupca::Int64, v.data(), v.size()); }
+
+	std::vector<std::string> ImenaStupaca() const override { return imena; }
+	TipStupca Tip(const std::string& ime) const override { return tipovi[Indeks(ime)]; }
+
+	void PostaviBrojUtora(unsigned brUtora) override { trenutni.assign(brUtora, std::vector<const void*>(imena.size(), nullptr)); }
+
+	const void* const* CitacStupca(const std::string& ime, unsigned utor) override { return &trenutni[utor][Indeks(ime)]; }
+
+	std::vector<std::pair<uint64_t, uint64_t>> RasponiRedova() const override
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> r;
+		for (uint64_t od = 0; od < brRedova; od += velicinaRaspona)
+			r.push_back({ od, std::min(brRedova, od + velicinaRaspona) });
+		return r;
+	}
+
+	void PostaviRed(unsigned utor, uint64_t red) override
+	{
+		for (size_t s = 0; s < podaci.size(); s++)
+			trenutni[utor][s] = (const uint8_t*)podaci[s] + red * 8;
+	}
+
+	size_t NajveciBlok() const override { return (size_t)velicinaRaspona; }
+
+private:
+	void Dodaj(const std::string& ime, TipStupca tip, const void* p, size_t n)
+	{
+		if (!imena.empty() && n != brRedova)
+			throw std::runtime_error("Stupac " + ime + " nema isti broj redova kao ostali");
+		imena.push_back(ime);
+		tipovi.push_back(tip);
+		podaci.push_back(p);
+		brRedova = n;
+	}
+
+	size_t Indeks(const std::string& ime) const
+	{
+		for (size_t s = 0; s < imena.size(); s++)
+			if (imena[s] == ime)
+				return s;
+		throw std::runtime_error("Nema stupca " + ime);
+	}
+
+	uint64_t brRedova = 0, velicinaRaspona;
+	std::vector<std::string> imena;
+	std::vector<TipStupca> tipovi;
+	std::vector<const void*> podaci;
+	std::vector<std::vector<const void*>> trenutni;
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "BazenDretvi.h"
+
+/*
+	KD stablo za tocke (x,y) u implicitnom rasporedu: tocke su poslozene tako da svaki cvor
+	pokriva neprekinuti raspon [lo, hi), djeca cvora v su 2v+1 i 2v+2, a od cvora se pamti
+	samo granica podjele. Listovi imaju najvise LIST tocaka koje su spremljene kao stupci x i y,
+	pa se udaljenosti unutar lista racunaju jednom petljom koju prevoditelj vektorizira.
+	Gornje razine stabla grade se paralelno, a upiti se obradjuju u skupinama.
+*/
+class KDStablo2D
+{
+public:
+	static const size_t LIST = 32;
+	static const uint32_t NITKO = std::numeric_limits<uint32_t>::max();
+
+	KDStablo2D(const double* x, const double* y, size_t n, unsigned brDretvi = 0) : n(n)
+	{
+		struct Tocka { double x, y; uint32_t id; };
+		std::vector<Tocka> t(n);
+		for (size_t i = 0; i < n; i++)
+			t[i] = { x[i], y[i], (uint32_t)i };
+
+		size_t brCvorova = 1;
+		for (size_t velicina = n; velicina > LIST; velicina = (velicina + 1) / 2)
+			brCvorova = 2 * brCvorova + 1;
+		granica.assign(brCvorova, 0.0);
+
+		if (brDretvi == 0)
+			brDretvi = std::max(1u, std::thread::hardware_concurrency());
+		int paralelnaDubina = 0;
+		while ((1u << paralelnaDubina) < brDretvi)
+			paralelnaDubina++;
+
+		/* Rekurzivna podjela po medijanu; na gornjih paralelnaDubina razina lijeva polovica ide u novu dretvu */
+		std::function<void(size_t, size_t, size_t, int)> gradi = [&](size_t v, size_t lo, size_t hi, int dubina) {
+			if (hi - lo <= LIST)
+				return;
+			size_t mid = lo + (hi - lo) / 2;
+			if (dubina % 2 == 0)
+				std::nth_element(t.begin() + lo, t.begin() + mid, t.begin() + hi, [](const Tocka& a, const Tocka& b) { return a.x < b.x; });
+			else
+				std::nth_element(t.begin() + lo, t.begin() + mid, t.begin() + hi, [](const Tocka& a, const Tocka& b) { return a.y < b.y; });
+			granica[v] = dubina % 2 == 0 ? t[mid].x : t[mid].y;
+			if (dubina < paralelnaDubina)
+			{
+				std::thread lijevo(gradi, 2 * v + 1, lo, mid, dubina + 1);
+				gradi(2 * v + 2, mid, hi, dubina + 1);
+				lijevo.join();
+			}
+			else
+			{
+				gradi(2 * v + 1, lo, mid, dubina + 1);
+				gradi(2 * v + 2, mid, hi, dubina + 1);
+			}
+		};
+		gradi(0, 0, n, 0);
+
+		px.resize(n);
+		py.resize(n);
+		id.resize(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			px[i] = t[i].x;
+			py[i] = t[i].y;
+			id[i] = t[i].id;
+		}
+	}
+
+	size_t Velicina() const { return n; }
+
+	/*
+		k najblizih susjeda za m upita (qx, qy). d2 i indeksi imaju m*k mjesta; indeksi su u izvornom
+		poretku tocaka. Ako je preskoci zadan, tocka s indeksom preskoci[i] se ne broji kao susjed upita i.
+	*/
+	void NajbliziSusjedi(const double* qx, const double* qy, size_t m, int k, double* d2, uint32_t* indeksi,
+		const uint32_t* preskoci = nullptr, BazenDretvi* bazen = nullptr) const
+	{
+		const size_t KOMAD = 4096;
+		auto obradi = [this, qx, qy, k, d2, indeksi, preskoci](size_t od, size_t doo) {
+			double udaljenosti[LIST];
+			for (size_t i = od; i < doo; i++)
+				Trazi(qx[i], qy[i], k, preskoci ? preskoci[i] : NITKO, d2 + i * k, indeksi + i * k, udaljenosti);
+		};
+		if (!bazen || m <= KOMAD)
+		{
+			obradi(0, m);
+			return;
+		}
+		std::vector<std::future<void>> gotovi;
+		for (size_t od = 0; od < m; od += KOMAD)
+			gotovi.push_back(bazen->Posalji([=] { obradi(od, std::min(m, od + KOMAD)); }));
+		for (auto& g : gotovi)
+			g.get();
+	}
+
+	/*
+		Najblizi susjed (razlicit od same tocke) za svaku tocku skupa. Upiti idu redom stabla,
+		pa susjedni upiti obilaze iste listove. Rezultat je u izvornom poretku tocaka.
+	*/
+	void NajbliziSusjedSkupa(std::vector<double>& d2, std::vector<uint32_t>& indeksi, BazenDretvi* bazen = nullptr) const
+	{
+		std::vector<double> d2Stablo(n);
+		std::vector<uint32_t> iStablo(n);
+		NajbliziSusjedi(px.data(), py.data(), n, 1, d2Stablo.data(), iStablo.data(), id.data(), bazen);
+		d2.resize(n);
+		indeksi.resize(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			d2[id[i]] = d2Stablo[i];
+			indeksi[id[i]] = iStablo[i];
+		}
+	}
+
+private:
+	void Trazi(double qx, double qy, int k, uint32_t preskoci, double* najD2, uint32_t* najI, double* udaljenosti) const
+	{
+		for (int j = 0; j < k; j++)
+		{
+			najD2[j] = std::numeric_limits<double>::infinity();
+			najI[j] = NITKO;
+		}
+		Spusti(0, 0, n, 0, qx, qy, k, preskoci, najD2, najI, udaljenosti);
+	}
+
+	void Spusti(size_t v, size_t lo, size_t hi, int dubina, double qx, double qy, int k, uint32_t preskoci,
+		double* najD2, uint32_t* najI, double* udaljenosti) const
+	{
+		if (hi - lo <= LIST)
+		{
+			/* Udaljenosti do svih tocaka lista u jednoj vektoriziranoj petlji, pa odabir */
+			size_t b = hi - lo;
+			const double* x = px.data() + lo;
+			const double* y = py.data() + lo;
+			for (size_t i = 0; i < b; i++)
+			{
+				double dx = x[i] - qx, dy = y[i] - qy;
+				udaljenosti[i] = dx * dx + dy * dy;
+			}
+			for (size_t i = 0; i < b; i++)
+			{
+				if (udaljenosti[i] >= najD2[k - 1] || id[lo + i] == preskoci)
+					continue;
+				int j = k - 1;
+				for (; j > 0 && najD2[j - 1] > udaljenosti[i]; j--)
+				{
+					najD2[j] = najD2[j - 1];
+					najI[j] = najI[j - 1];
+				}
+				najD2[j] = udaljenosti[i];
+				najI[j] = id[lo + i];
+			}
+			return;
+		}
+		size_t mid = lo + (hi - lo) / 2;
+		double razlika = (dubina % 2 == 0 ? qx : qy) - granica[v];
+		if (razlika < 0)
+		{
+			Spusti(2 * v + 1, lo, mid, dubina + 1, qx, qy, k, preskoci, najD2, najI, udaljenosti);
+			if (razlika * razlika < najD2[k - 1])
+				Spusti(2 * v + 2, mid, hi, dubina + 1, qx, qy, k, preskoci, najD2, najI, udaljenosti);
+		}
+		else
+		{
+			Spusti(2 * v + 2, mid, hi, dubina + 1, qx, qy, k, preskoci, najD2, najI, udaljenosti);
+			if (razlika * razlika < najD2[k - 1])
+				Spusti(2 * v + 1, lo, mid, dubina + 1, qx, qy, k, preskoci, najD2, najI, udaljenosti);
+		}
+	}
+
+	size_t n;
+	std::vector<double> px, py, granica;
+	std::vector<uint32_t> id;
+};
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+	Mali vektor za kratke nizove po redu (npr. \pi-jevi jednog ponavljanja po eksponentu) i
+	rezultate izraza nad njima (Map, Filter, Take, aritmetika, usporedbe), po uzoru na RVec.
+
+	Do N elemenata stoji u samom objektu, bez alokacije. Veci niz ide na gomilu, ili u arenu ako
+	je zadana: arena je blok memorije po utoru iz kojeg se samo pomice vrh, a nakon obrade reda
+	Resetiraj() sve oslobodi odjednom. Rezultat izraza koristi arenu lijevog operanda, pa cijeli
+	lanac izraza nad jednim redom ne ide na gomilu. Vektor iz arene ne smije zivjeti dulje od
+	sljedeceg Resetiraj().
+
+	Samo za trivijalno kopirljive tipove (brojeve); elementi se kopiraju s memcpy.
+*/
+
+/* Ukupan broj alokacija na gomili iz malih vektora i aren, za provjeru u mjerenjima */
+inline std::atomic<uint64_t>& BrojAlokacijaGomile()
+{
+	static std::atomic<uint64_t> br{ 0 };
+	return br;
+}
+
+class Arena
+{
+public:
+	explicit Arena(size_t velicinaBloka = 1 << 16) : velicinaBloka(velicinaBloka) {}
+
+	~Arena()
+	{
+		for (Blok& b : blokovi)
+			::operator delete(b.podaci);
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* Alociraj(size_t bajtova, size_t poravnanje)
+	{
+		for (;;)
+		{
+			if (trenutni < blokovi.size())
+			{
+				Blok& b = blokovi[trenutni];
+				uintptr_t p = ((uintptr_t)b.podaci + vrh + poravnanje - 1) & ~(uintptr_t)(poravnanje - 1);
+				size_t kraj = (size_t)(p - (uintptr_t)b.podaci) + bajtova;
+				if (kraj <= b.velicina)
+				{
+					vrh = kraj;
+					return (void*)p;
+				}
+				trenutni++;
+				vrh = 0;
+				continue;
+			}
+			size_t velicina = std::max(velicinaBloka, bajtova + poravnanje);
+			blokovi.push_back({ ::operator new(velicina), velicina });
+			BrojAlokacijaGomile()++;
+		}
+	}
+
+	/* Sva memorija iz arene je ponovno slobodna; blokovi ostaju za sljedeci red */
+	void Resetiraj()
+	{
+		trenutni = 0;
+		vrh = 0;
+	}
+
+	size_t BrojBlokova() const { return blokovi.size(); }
+
+private:
+	struct Blok
+	{
+		void* podaci;
+		size_t velicina;
+	};
+
+	size_t velicinaBloka;
+	std::vector<Blok> blokovi;
+	size_t trenutni = 0, vrh = 0;
+};
+
+/*
+	Izrazi nad malim vektorima su lijeni: v1 * v1 + v2 * v2 <= 1.0 je stablo cvorova koje drzi
+	reference na vektore, a racuna se tek jednom petljom pri dodjeli u MaliVektor ili u Sum/Mean,
+	bez privremenih vektora. Zato izraz ne smije nadzivjeti vektore iz kojih je nastao
+	(auto e = Map(...) * 2.0 visi).
+*/
+template <class E>
+struct Izraz
+{
+	const E& Sam() const { return static_cast<const E&>(*this); }
+};
+
+template <class T, size_t N>
+class MaliVektor;
+
+/* Broj u izrazu; LOKALNO == 0 oznacava da nema svoju duljinu */
+template <class T>
+struct Skalar : Izraz<Skalar<T>>
+{
+	typedef T value_type;
+	static constexpr size_t LOKALNO = 0;
+	T v;
+	explicit Skalar(T v) : v(v) {}
+	size_t size() const { return 0; }
+	T operator[](size_t) const { return v; }
+	Arena* KojaArena() const { return nullptr; }
+};
+
+/* Duljina cvora iz duljina operanada; skalari (lokalno == 0) se ne broje, ostali moraju biti jednaki */
+inline size_t ZajednickaDuljina(size_t lokalno1, size_t n1, size_t lokalno2, size_t n2)
+{
+	if (lokalno1 && lokalno2 && n1 != n2)
+		throw std::runtime_error("Vektori u izrazu imaju razlicite duljine");
+	return lokalno1 ? n1 : n2;
+}
+
+/* Vektor se u cvoru drzi po referenci, a cvorovi i brojevi po vrijednosti */
+template <class E>
+struct CvorIzraza
+{
+	typedef E type;
+};
+
+template <class T, size_t N>
+struct CvorIzraza<MaliVektor<T, N>>
+{
+	typedef const MaliVektor<T, N>& type;
+};
+
+template <class L, class R, class Op>
+struct Binarni : Izraz<Binarni<L, R, Op>>
+{
+	typedef decltype(Op()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>())) value_type;
+	static constexpr size_t LOKALNO = L::LOKALNO ? L::LOKALNO : R::LOKALNO;
+	typename CvorIzraza<L>::type l;
+	typename CvorIzraza<R>::type r;
+	size_t n;
+	Binarni(const L& l, const R& r) : l(l), r(r), n(ZajednickaDuljina(L::LOKALNO, l.size(), R::LOKALNO, r.size())) {}
+	size_t size() const { return n; }
+	value_type operator[](size_t i) const { return Op()(l[i], r[i]); }
+	Arena* KojaArena() const { return l.KojaArena() ? l.KojaArena() : r.KojaArena(); }
+};
+
+template <class M, class A, class B>
+struct Ternarni : Izraz<Ternarni<M, A, B>>
+{
+	typedef typename std::common_type<typename A::value_type, typename B::value_type>::type value_type;
+	static constexpr size_t LOKALNO = M::LOKALNO ? M::LOKALNO : A::LOKALNO ? A::LOKALNO : B::LOKALNO;
+	typename CvorIzraza<M>::type m;
+	typename CvorIzraza<A>::type a;
+	typename CvorIzraza<B>::type b;
+	size_t n;
+	Ternarni(const M& m, const A& a, const B& b)
+		: m(m), a(a), b(b), n(ZajednickaDuljina(M::LOKALNO, m.size(), A::LOKALNO ? A::LOKALNO : B::LOKALNO,
+			ZajednickaDuljina(A::LOKALNO, a.size(), B::LOKALNO, b.size())))
+	{
+	}
+	size_t size() const { return n; }
+	value_type operator[](size_t i) const { return m[i] ? (value_type)a[i] : (value_type)b[i]; }
+	Arena* KojaArena() const { return a.KojaArena() ? a.KojaArena() : b.KojaArena() ? b.KojaArena() : m.KojaArena(); }
+};
+
+template <class T, size_t N = 8>
+class MaliVektor : public Izraz<MaliVektor<T, N>>
+{
+	static_assert(std::is_trivially_copyable<T>::value, "MaliVektor je samo za trivijalno kopirljive tipove");
+	static_assert(N > 0, "MaliVektor treba barem jedan lokalni element");
+
+public:
+	typedef T value_type;
+	static constexpr size_t LOKALNO = N;
+
+	explicit MaliVektor(Arena* arena = nullptr) : arena(arena) {}
+
+	/* Izraz se racuna jednom petljom ravno u ovaj vektor, u areni izraza */
+	template <class E>
+	MaliVektor(const Izraz<E>& izraz) : arena(izraz.Sam().KojaArena())
+	{
+		Izracunaj(izraz.Sam());
+	}
+
+	template <class E>
+	MaliVektor& operator=(const Izraz<E>& izraz)
+	{
+		Izracunaj(izraz.Sam());
+		return *this;
+	}
+
+	MaliVektor(size_t n, T v, Arena* arena = nullptr) : arena(arena)
+	{
+		resize(n, v);
+	}
+
+	MaliVektor(std::initializer_list<T> l, Arena* arena = nullptr) : arena(arena)
+	{
+		reserve(l.size());
+		for (const T& v : l)
+			podaci[n++] = v;
+	}
+
+	MaliVektor(const MaliVektor& v) : arena(v.arena)
+	{
+		reserve(v.n);
+		if (v.n)
+			std::memcpy(podaci, v.podaci, v.n * sizeof(T));
+		n = v.n;
+	}
+
+	/* Vektor na gomili ili u areni preuzima se bez kopiranja; lokalni se kopira */
+	MaliVektor(MaliVektor&& v) noexcept : arena(v.arena) { Preuzmi(v); }
+
+	MaliVektor& operator=(const MaliVektor& v)
+	{
+		if (this != &v)
+		{
+			n = 0;
+			reserve(v.n);
+			if (v.n)
+				std::memcpy(podaci, v.podaci, v.n * sizeof(T));
+			n = v.n;
+		}
+		return *this;
+	}
+
+	MaliVektor& operator=(MaliVektor&& v) noexcept
+	{
+		if (this != &v)
+		{
+			Oslobodi();
+			podaci = (T*)lokalno;
+			kapacitet = N;
+			arena = v.arena;
+			Preuzmi(v);
+		}
+		return *this;
+	}
+
+	~MaliVektor() { Oslobodi(); }
+
+	size_t size() const { return n; }
+	bool empty() const { return n == 0; }
+	size_t capacity() const { return kapacitet; }
+	T* data() { return podaci; }
+	const T* data() const { return podaci; }
+	T& operator[](size_t i) { return podaci[i]; }
+	const T& operator[](size_t i) const { return podaci[i]; }
+	T* begin() { return podaci; }
+	T* end() { return podaci + n; }
+	const T* begin() const { return podaci; }
+	const T* end() const { return podaci + n; }
+	Arena* KojaArena() const { return arena; }
+
+	void clear() { n = 0; }
+
+	void push_back(T v)
+	{
+		if (n == kapacitet)
+			reserve(2 * kapacitet);
+		podaci[n++] = v;
+	}
+
+	void resize(size_t m, T v = T())
+	{
+		reserve(m);
+		for (size_t i = n; i < m; i++)
+			podaci[i] = v;
+		n = m;
+	}
+
+	void reserve(size_t m)
+	{
+		if (m <= kapacitet)
+			return;
+		T* novi;
+		if (arena)
+			novi = (T*)arena->Alociraj(m * sizeof(T), alignof(T));
+		else
+		{
+			novi = (T*)::operator new(m * sizeof(T));
+			BrojAlokacijaGomile()++;
+		}
+		if (n)
+			std::memcpy(novi, podaci, n * sizeof(T));
+		Oslobodi();
+		podaci = novi;
+		kapacitet = m;
+		naGomili = !arena;
+	}
+
+private:
+	template <class E>
+	void Izracunaj(const E& e)
+	{
+		size_t m = e.size();
+		reserve(m);
+		T* p = podaci;
+		for (size_t i = 0; i < m; i++)
+			p[i] = (T)e[i];
+		n = m;
+	}
+
+	bool Lokalno() const { return podaci == (const T*)lokalno; }
+
+	/* Ovaj vektor je prazan i lokalan; v ostaje prazan i lokalan */
+	void Preuzmi(MaliVektor& v)
+	{
+		if (v.Lokalno())
+		{
+			if (v.n)
+				std::memcpy(lokalno, v.podaci, v.n * sizeof(T));
+		}
+		else
+		{
+			podaci = v.podaci;
+			kapacitet = v.kapacitet;
+			naGomili = v.naGomili;
+			v.podaci = (T*)v.lokalno;
+			v.kapacitet = N;
+			v.naGomili = false;
+		}
+		n = v.n;
+		v.n = 0;
+	}
+
+	void Oslobodi()
+	{
+		if (naGomili)
+			::operator delete(podaci);
+		naGomili = false;
+	}
+
+	T* podaci = (T*)lokalno;
+	size_t n = 0, kapacitet = N;
+	Arena* arena;
+	bool naGomili = false;
+	alignas(T) unsigned char lokalno[N * sizeof(T)];
+};
+
+/* f(x) za svaki element */
+template <class E, class F>
+auto Map(const Izraz<E>& izraz, F f) -> MaliVektor<typename std::decay<decltype(f(izraz.Sam()[0]))>::type, E::LOKALNO>
+{
+	const E& e = izraz.Sam();
+	MaliVektor<typename std::decay<decltype(f(e[0]))>::type, E::LOKALNO> r(e.KojaArena());
+	r.resize(e.size());
+	for (size_t i = 0; i < e.size(); i++)
+		r[i] = f(e[i]);
+	return r;
+}
+
+/* Elementi za koje p(x) vrijedi */
+template <class E, class P>
+MaliVektor<typename E::value_type, E::LOKALNO> Filter(const Izraz<E>& izraz, P p)
+{
+	const E& e = izraz.Sam();
+	MaliVektor<typename E::value_type, E::LOKALNO> r(e.KojaArena());
+	r.reserve(e.size());
+	for (size_t i = 0; i < e.size(); i++)
+	{
+		typename E::value_type v = e[i];
+		if (p(v))
+			r.push_back(v);
+	}
+	return r;
+}
+
+/* Elementi na mjestima gdje je maska istinita, npr. Filter(x, x * x + y * y <= 1.0) */
+template <class E, class M>
+MaliVektor<typename E::value_type, E::LOKALNO> Filter(const Izraz<E>& izraz, const Izraz<M>& maska)
+{
+	const E& e = izraz.Sam();
+	const M& m = maska.Sam();
+	MaliVektor<typename E::value_type, E::LOKALNO> r(e.KojaArena());
+	r.reserve(e.size());
+	for (size_t i = 0; i < e.size(); i++)
+		if (m[i])
+			r.push_back(e[i]);
+	return r;
+}
+
+/* Elementi na zadanim indeksima */
+template <class T, size_t N, class I, size_t M>
+MaliVektor<T, N> Take(const MaliVektor<T, N>& v, const MaliVektor<I, M>& indeksi)
+{
+	MaliVektor<T, N> r(v.KojaArena());
+	r.reserve(indeksi.size());
+	for (size_t i = 0; i < indeksi.size(); i++)
+		r.push_back(v[(size_t)indeksi[i]]);
+	return r;
+}
+
+template <class E>
+auto Sum(const Izraz<E>& izraz) -> decltype(std::declval<typename E::value_type>() + std::declval<typename E::value_type>())
+{
+	typedef decltype(std::declval<typename E::value_type>() + std::declval<typename E::value_type>()) S;
+	const E& e = izraz.Sam();
+	size_t n = e.size(), i = 0;
+	S s = S();
+	if (std::is_floating_point<S>::value)
+	{
+		/* Cetiri neovisna zbroja, da zbrajanje ne ceka prethodno i da se petlja moze vektorizirati */
+		S s0 = S(), s1 = S(), s2 = S(), s3 = S();
+		for (; i + 4 <= n; i += 4)
+		{
+			s0 += e[i];
+			s1 += e[i + 1];
+			s2 += e[i + 2];
+			s3 += e[i + 3];
+		}
+		s = (s0 + s1) + (s2 + s3);
+	}
+	for (; i < n; i++)
+		s += e[i];
+	return s;
+}
+
+template <class E>
+double Mean(const Izraz<E>& izraz)
+{
+	size_t n = izraz.Sam().size();
+	return n ? (double)Sum(izraz) / n : 0.0;
+}
+
+/* Operacije element po element; rezultat je lijeni cvor koji se racuna tek pri dodjeli ili zbrajanju */
+#define MALI_VEKTOR_OPERATOR(op, Ime)                                                                              \
+	struct Ime                                                                                                     \
+	{                                                                                                              \
+		template <class A, class B>                                                                                \
+		auto operator()(A a, B b) const -> decltype(a op b) { return a op b; }                                     \
+	};                                                                                                             \
+	template <class L, class R>                                                                                    \
+	Binarni<L, R, Ime> operator op(const Izraz<L>& a, const Izraz<R>& b) { return Binarni<L, R, Ime>(a.Sam(), b.Sam()); } \
+	template <class L, class S, class = typename std::enable_if<std::is_arithmetic<S>::value>::type>              \
+	Binarni<L, Skalar<S>, Ime> operator op(const Izraz<L>& a, S b) { return Binarni<L, Skalar<S>, Ime>(a.Sam(), Skalar<S>(b)); } \
+	template <class S, class R, class = typename std::enable_if<std::is_arithmetic<S>::value>::type>              \
+	Binarni<Skalar<S>, R, Ime> operator op(S a, const Izraz<R>& b) { return Binarni<Skalar<S>, R, Ime>(Skalar<S>(a), b.Sam()); }
+
+MALI_VEKTOR_OPERATOR(+, OpZbroj)
+MALI_VEKTOR_OPERATOR(-, OpRazlika)
+MALI_VEKTOR_OPERATOR(*, OpUmnozak)
+MALI_VEKTOR_OPERATOR(/, OpKvocijent)
+MALI_VEKTOR_OPERATOR(<, OpManje)
+MALI_VEKTOR_OPERATOR(<=, OpManjeJednako)
+MALI_VEKTOR_OPERATOR(>, OpVece)
+MALI_VEKTOR_OPERATOR(>=, OpVeceJednako)
+MALI_VEKTOR_OPERATOR(==, OpJednako)
+MALI_VEKTOR_OPERATOR(!=, OpRazlicito)
+MALI_VEKTOR_OPERATOR(&&, OpI)
+MALI_VEKTOR_OPERATOR(||, OpIli)
+
+#undef MALI_VEKTOR_OPERATOR
+
+template <class E>
+const E& KaoIzraz(const Izraz<E>& e)
+{
+	return e.Sam();
+}
+
+template <class S, class = typename std::enable_if<std::is_arithmetic<S>::value>::type>
+Skalar<S> KaoIzraz(S s)
+{
+	return Skalar<S>(s);
+}
+
+/* maska[i] ? a[i] : b[i]; a i b mogu biti i brojevi, npr. Sum(Gdje(x * x + y * y <= 1.0, w, 0.0)) */
+template <class M, class A, class B>
+auto Gdje(const Izraz<M>& maska, const A& a, const B& b)
+	-> Ternarni<M, typename std::decay<decltype(KaoIzraz(a))>::type, typename std::decay<decltype(KaoIzraz(b))>::type>
+{
+	return Ternarni<M, typename std::decay<decltype(KaoIzraz(a))>::type, typename std::decay<decltype(KaoIzraz(b))>::type>(
+		maska.Sam(), KaoIzraz(a), KaoIzraz(b));
+}
+
+/*
+	Alokator koji broji alokacije, za usporedbu sa std::vector u mjerenjima
+*/
+template <class T>
+struct BrojeciAlokator
+{
+	typedef T value_type;
+	BrojeciAlokator() = default;
+	template <class U>
+	BrojeciAlokator(const BrojeciAlokator<U>&) {}
+	T* allocate(size_t n)
+	{
+		BrojAlokacijaGomile()++;
+		return (T*)::operator new(n * sizeof(T));
+	}
+	void deallocate(T* p, size_t) { ::operator delete(p); }
+	template <class U>
+	bool operator==(const BrojeciAlokator<U>&) const { return true; }
+	template <class U>
+	bool operator!=(const BrojeciAlokator<U>&) const { return false; }
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "BazenDretvi.h"
+
+/*
+	Minimizacija skupih funkcija s numerickim gradijentom (varijabilna metrika, BFGS).
+	Gradijent iz centralnih razlika trazi 2*npar poziva funkcije; ako je zadan bazen dretvi,
+	svi se pozivi salju odjednom, a rezultati se slazu uvijek istim redom (po indeksu parametra),
+	pa je rezultat isti kao u serijskom racunanju.
+*/
+
+typedef std::function<double(const std::vector<double>&)> FunkcijaCilja;
+
+struct RezultatMinimizacije
+{
+	std::vector<double> x;
+	double f = 0.0;
+	int brIteracija = 0;
+	long long brPoziva = 0;
+	bool konvergirao = false;
+};
+
+/* Gradijent centralnim razlikama, (f(x+h e_i) - f(x-h e_i)) / 2h */
+inline std::vector<double> NumerickiGradijent(const FunkcijaCilja& f, const std::vector<double>& x, double relKorak,
+	BazenDretvi* bazen, long long& brPoziva)
+{
+	size_t npar = x.size();
+	std::vector<double> h(npar), vrijednosti(2 * npar);
+	for (size_t i = 0; i < npar; i++)
+		h[i] = relKorak * std::max(1.0, fabs(x[i]));
+
+	auto izracunaj = [&](size_t k) {
+		std::vector<double> xk = x;
+		xk[k / 2] += (k % 2 == 0) ? h[k / 2] : -h[k / 2];
+		vrijednosti[k] = f(xk);
+	};
+	if (bazen)
+	{
+		std::vector<std::future<void>> gotovi;
+		for (size_t k = 0; k < 2 * npar; k++)
+			gotovi.push_back(bazen->Posalji([&izracunaj, k] { izracunaj(k); }));
+		/* Svi zadaci moraju zavrsiti prije izlaska jer drze reference na izracunaj, vrijednosti, h i x */
+		std::exception_ptr greska;
+		for (auto& g : gotovi)
+			try
+			{
+				g.get();
+			}
+			catch (...)
+			{
+				if (!greska)
+					greska = std::current_exception();
+			}
+		if (greska)
+			std::rethrow_exception(greska);
+	}
+	else
+		for (size_t k = 0; k < 2 * npar; k++)
+			izracunaj(k);
+	brPoziva += 2 * npar;
+
+	std::vector<double> g(npar);
+	for (size_t i = 0; i < npar; i++)
+		g[i] = (vrijednosti[2 * i] - vrijednosti[2 * i + 1]) / (2.0 * h[i]);
+	return g;
+}
+
+inline double Skalarni(const std::vector<double>& a, const std::vector<double>& b)
+{
+	double s = 0.0;
+	for (size_t i = 0; i < a.size(); i++)
+		s += a[i] * b[i];
+	return s;
+}
+
+/* BFGS s inverznom Hessovom matricom i Armijo-vim skracivanjem koraka */
+inline RezultatMinimizacije MinimizirajBFGS(const FunkcijaCilja& f, std::vector<double> x, BazenDretvi* bazen = nullptr,
+	int maxIteracija = 500, double tolerancija = 1e-10, double relKorak = 1e-5)
+{
+	RezultatMinimizacije r;
+	size_t npar = x.size();
+	std::vector<double> H(npar * npar, 0.0);
+	for (size_t i = 0; i < npar; i++)
+		H[i * npar + i] = 1.0;
+
+	double fx = f(x);
+	r.brPoziva = 1;
+	std::vector<double> g = NumerickiGradijent(f, x, relKorak, bazen, r.brPoziva);
+	bool prviKorak = true;
+
+	for (r.brIteracija = 0; r.brIteracija < maxIteracija; r.brIteracija++)
+	{
+		std::vector<double> d(npar, 0.0);
+		for (size_t i = 0; i < npar; i++)
+			for (size_t j = 0; j < npar; j++)
+				d[i] -= H[i * npar + j] * g[j];
+		double nagib = Skalarni(d, g);
+		if (nagib >= 0.0)
+		{
+			/* Smjer nije silazni: povratak na gradijent */
+			std::fill(H.begin(), H.end(), 0.0);
+			for (size_t i = 0; i < npar; i++)
+			{
+				H[i * npar + i] = 1.0;
+				d[i] = -g[i];
+			}
+			nagib = -Skalarni(g, g);
+			prviKorak = true;
+		}
+
+		double alfa = 1.0, fNovi = fx;
+		std::vector<double> xNovi(npar);
+		for (int k = 0; k < 60; k++, alfa *= 0.5)
+		{
+			for (size_t i = 0; i < npar; i++)
+				xNovi[i] = x[i] + alfa * d[i];
+			fNovi = f(xNovi);
+			r.brPoziva++;
+			if (fNovi <= fx + 1e-4 * alfa * nagib)
+				break;
+		}
+		if (!(fNovi < fx))
+		{
+			r.konvergirao = true;
+			break;
+		}
+
+		std::vector<double> gNovi = NumerickiGradijent(f, xNovi, relKorak, bazen, r.brPoziva);
+		std::vector<double> s(npar), y(npar);
+		for (size_t i = 0; i < npar; i++)
+		{
+			s[i] = xNovi[i] - x[i];
+			y[i] = gNovi[i] - g[i];
+		}
+		double sy = Skalarni(s, y);
+		bool gotovo = fx - fNovi <= tolerancija * (fabs(fx) + fabs(fNovi) + 1e-300);
+		x = xNovi;
+		fx = fNovi;
+		g = gNovi;
+		if (gotovo)
+		{
+			r.konvergirao = true;
+			break;
+		}
+		if (sy <= 0.0)
+			continue;
+
+		if (prviKorak)
+		{
+			/* Pocetna skala H = (s.y / y.y) I */
+			double skala = sy / Skalarni(y, y);
+			for (size_t i = 0; i < npar; i++)
+				H[i * npar + i] = skala;
+			prviKorak = false;
+		}
+
+		/* H = (I - rho s y^T) H (I - rho y s^T) + rho s s^T */
+		double rho = 1.0 / sy;
+		std::vector<double> Hy(npar, 0.0);
+		for (size_t i = 0; i < npar; i++)
+			for (size_t j = 0; j < npar; j++)
+				Hy[i] += H[i * npar + j] * y[j];
+		double yHy = Skalarni(y, Hy);
+		for (size_t i = 0; i < npar; i++)
+			for (size_t j = 0; j < npar; j++)
+				H[i * npar + j] += -rho * (Hy[i] * s[j] + s[i] * Hy[j]) + (rho * rho * yHy + rho) * s[i] * s[j];
+	}
+	r.x = x;
+	r.f = fx;
+	return r;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BazenDretvi.h"
+
+/*
+	Objekt s kopijom po dretvi (npr. histogram koji sve dretve pune): Get vraca kopiju dretve
+	bez zakljucavanja, a Spoji ih na kraju zbraja metodom T::Dodaj(const T&).
+
+	Get prvo gleda malu predmemoriju u thread_local (nekoliko zadnjih objekata ove dretve), pa je
+	uobicajeni poziv jedna usporedba; tek prvi poziv u dretvi ide pod mutex i stvara kopiju.
+	Kopija se stvara u dretvi koja je koristi, pa uz prvi dodir (Linux i Windows zadano) memorija
+	zavrsava na NUMA cvoru te dretve, posebno uz prikvacene dretve bazena.
+
+	Dretva koja je gotova moze pozvati Predaj: njezina se kopija odmah spaja u binarno stablo
+	djelomicnih zbrojeva (razina k drzi zbroj 2^k kopija, kao prijenos pri binarnom zbrajanju),
+	dok ostale dretve jos pune svoje. Spajanje tako tece usporedo s punjenjem, djelomicnih zbrojeva
+	je najvise log2 predanih kopija, a Spoji na kraju zbraja samo njih i kopije koje nisu predane.
+*/
+template <class T>
+class ObjektPoDretvi
+{
+public:
+	/* Kopije se stvaraju kao T(argumenti...) */
+	template <class... A>
+	explicit ObjektPoDretvi(A... argumenti)
+		: stvori([argumenti...] { return std::unique_ptr<T>(new T(argumenti...)); }), id(NoviId())
+	{
+	}
+
+	ObjektPoDretvi(const ObjektPoDretvi&) = delete;
+	ObjektPoDretvi& operator=(const ObjektPoDretvi&) = delete;
+
+	/* Kopija ove dretve; prvi poziv u dretvi je stvara */
+	T& Get()
+	{
+		uint64_t trenutni = id.load(std::memory_order_acquire);
+		Predmemorija& p = TLS();
+		for (const Unos& u : p.unosi)
+			if (u.id == trenutni)
+				return *u.objekt;
+		return Sporo(trenutni);
+	}
+
+	/* Dretva predaje svoju kopiju na spajanje; sljedeci Get u njoj stvara novu */
+	void Predaj()
+	{
+		std::unique_ptr<T> kopija;
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			auto it = std::find_if(zive.begin(), zive.end(), [](const Kopija& k) { return k.dretva == std::this_thread::get_id(); });
+			if (it == zive.end())
+				return;
+			kopija = std::move(it->objekt);
+			zive.erase(it);
+		}
+		Zaboravi(id.load(std::memory_order_relaxed));
+		Umetni(std::move(kopija));
+	}
+
+	/*
+		Zbroj svih kopija, nakon cega objekt pocinje ispocetka. Ne smije se zvati dok druge dretve
+		koriste Get. Uz bazen se preostale kopije zbrajaju u parovima usporedo.
+	*/
+	std::unique_ptr<T> Spoji(BazenDretvi* bazen = nullptr)
+	{
+		std::vector<std::unique_ptr<T>> dijelovi;
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			for (Kopija& k : zive)
+				dijelovi.push_back(std::move(k.objekt));
+			for (auto& r : razine)
+				if (r)
+					dijelovi.push_back(std::move(r));
+			zive.clear();
+			razine.clear();
+			/* Kopije u predmemorijama ostalih dretvi vise ne vrijede */
+			id.store(NoviId(), std::memory_order_release);
+		}
+		if (dijelovi.empty())
+			return stvori();
+		while (dijelovi.size() > 1)
+		{
+			size_t parova = dijelovi.size() / 2;
+			auto spoji = [&dijelovi](size_t i) { dijelovi[2 * i]->Dodaj(*dijelovi[2 * i + 1]); };
+			if (bazen && parova > 1)
+				bazen->Foreach(parova, spoji, 1);
+			else
+				for (size_t i = 0; i < parova; i++)
+					spoji(i);
+			for (size_t i = 0; i < parova; i++)
+				dijelovi[i] = std::move(dijelovi[2 * i]);
+			if (dijelovi.size() % 2)
+				dijelovi[parova] = std::move(dijelovi.back());
+			dijelovi.resize(dijelovi.size() - parova);
+			brKopija.fetch_sub(parova, std::memory_order_relaxed);
+		}
+		brKopija.fetch_sub(1, std::memory_order_relaxed);
+		return std::move(dijelovi[0]);
+	}
+
+	/* Zbroj trenutnog stanja bez diranja kopija (kao SnapshotMerge); isto ne smije teci uz Get */
+	std::unique_ptr<T> Snimka()
+	{
+		std::unique_ptr<T> zbroj = stvori();
+		std::lock_guard<std::mutex> l(mtx);
+		for (const Kopija& k : zive)
+			zbroj->Dodaj(*k.objekt);
+		for (const auto& r : razine)
+			if (r)
+				zbroj->Dodaj(*r);
+		return zbroj;
+	}
+
+	/* Najveci broj kopija (zivih i djelomicnih zbrojeva) koje su istovremeno postojale */
+	size_t NajviseKopija() const { return najviseKopija.load(std::memory_order_relaxed); }
+
+private:
+	struct Kopija
+	{
+		std::thread::id dretva;
+		std::unique_ptr<T> objekt;
+	};
+
+	static constexpr size_t UNOSA = 8;
+
+	struct Unos
+	{
+		uint64_t id = 0;
+		T* objekt = nullptr;
+	};
+
+	struct Predmemorija
+	{
+		Unos unosi[UNOSA];
+		size_t sljedeci = 0;
+	};
+
+	static Predmemorija& TLS()
+	{
+		static thread_local Predmemorija p;
+		return p;
+	}
+
+	/* Id se mijenja pri svakom Spoji, pa stari unosi u predmemorijama sami promasuju */
+	static uint64_t NoviId()
+	{
+		static std::atomic<uint64_t> brojac{ 0 };
+		return ++brojac;
+	}
+
+	static void Zaboravi(uint64_t stari)
+	{
+		for (Unos& u : TLS().unosi)
+			if (u.id == stari)
+				u = Unos();
+	}
+
+	T& Sporo(uint64_t trenutni)
+	{
+		T* objekt;
+		{
+			std::lock_guard<std::mutex> l(mtx);
+			auto it = std::find_if(zive.begin(), zive.end(), [](const Kopija& k) { return k.dretva == std::this_thread::get_id(); });
+			objekt = it != zive.end() ? it->objekt.get() : nullptr;
+		}
+		if (!objekt)
+		{
+			/* Stvaranje izvan mutexa, u ovoj dretvi (prvi dodir memorije) */
+			Kopija k{ std::this_thread::get_id(), stvori() };
+			objekt = k.objekt.get();
+			Brojeno(1);
+			std::lock_guard<std::mutex> l(mtx);
+			zive.push_back(std::move(k));
+		}
+		Predmemorija& p = TLS();
+		p.unosi[p.sljedeci++ % UNOSA] = Unos{ trenutni, objekt };
+		return *objekt;
+	}
+
+	void Umetni(std::unique_ptr<T> o)
+	{
+		for (size_t r = 0;; r++)
+		{
+			std::unique_ptr<T> drugi;
+			{
+				std::lock_guard<std::mutex> l(mtx);
+				if (razine.size() <= r)
+					razine.resize(r + 1);
+				if (!razine[r])
+				{
+					razine[r] = std::move(o);
+					return;
+				}
+				drugi = std::move(razine[r]);
+			}
+			o->Dodaj(*drugi);
+			drugi.reset();
+			Brojeno(-1);
+		}
+	}
+
+	void Brojeno(long long promjena)
+	{
+		size_t n = brKopija.fetch_add((size_t)promjena, std::memory_order_relaxed) + (size_t)promjena;
+		size_t staro = najviseKopija.load(std::memory_order_relaxed);
+		while (n > staro && !najviseKopija.compare_exchange_weak(staro, n, std::memory_order_relaxed))
+			;
+	}
+
+	std::function<std::unique_ptr<T>()> stvori;
+	std::atomic<uint64_t> id;
+	std::mutex mtx;
+	std::vector<Kopija> zive;
+	std::vector<std::unique_ptr<T>> razine;
+	std::atomic<size_t> brKopija{ 0 }, najviseKopija{ 0 };
+};
@@ -6,7 +6,36 @@
 #include <math.h>
 #include <time.h>
 #include <iomanip>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <shared_mutex>
+#include <thread>
 
+#include "BazenDretvi.h"
+#include "Binomna.h"
+#include "Buducnost.h"
+#include "Efikasnost.h"
+#include "Histogram.h"
+#include "HistogramRijetki.h"
+#include "IzvorCSV.h"
+#include "KDStablo.h"
+#include "MaliVektor.h"
+#include "Minimizacija.h"
+#include "ObjektPoDretvi.h"
+#include "Prilagodba.h"
+#include "Rezultati.h"
+#include "SlucajniIzvor.h"
+#include "SmanjenjeVarijance.h"
+#include "Spremiste.h"
+#include "Statistika.h"
+#include "StupcanaDatoteka.h"
+#include "TestGeneratora.h"
+#include "ZakljucavanjeRW.h"
+#include "ZamjenaBajtova.h"
 
 using namespace std;
 
@@ -16,48 +45,414 @@ using namespace std;
 	Upisati kružnicu radiusa 1, površine 1 * 1 * \pi= \pi. Prebrojati koliko se točaka nalazi u kružnici.
 	BrTuKrug/BrTuKvad=\pi/4
 */
-int main()
+const double PI = 3.14159265358979323846;
+
+/*
+	Nacini rada: 1 - puna simulacija (svaki par (x,y) se generira),
+	2 - binomna provjera: broj tocaka u krugu izvlaci se izravno iz Binomial(10^j, \pi/4) (BTPE),
+	3 - oba nacina i usporedba razdioba \pi-jeva po eksponentu (KS i Anderson-Darling test).
+*/
+long long BrojTocakaUKrugu(long long brTocaka, int nacin, mt19937_64& gen)
 {
-	cout << std::fixed;
-	cout << std::setprecision(5);
-	srand(time(NULL));
-	double rand_x, rand_y, BrPi[11][11];
-	double polozaj;
-	int n;
-	char odg, odg1;
-	double srVrij[11] = {0.0}, stDev[11] = { 0.0 };
-	
-	do
+	if (nacin == 2)
+		return BinomnaBTPE(gen, brTocaka, PI / 4);
+
+	double rand_x, rand_y, polozaj;
+	long long BrTuKrug = 0;
+	for (long long i = 0; i < brTocaka; i++)
 	{
-	cout << "Unesi potenciju: " << endl;
-	cin >> n;
+		rand_x = ((double)rand() / (RAND_MAX));
+		rand_y = ((double)rand() / (RAND_MAX));
+		polozaj = pow(rand_x, 2) + pow(rand_y, 2);
+		if (sqrt(polozaj) <= 1)
+			BrTuKrug++;
+	}
+	return BrTuKrug;
+}
+
+/* Jedan red datoteke rezultata po (ponavljanje, eksponent) */
+struct RedRezultata
+{
+	int64_t ponavljanje, eksponent, brTocaka, uKrugu;
+	double pi;
+};
 
-	for (int k = 0; k < n; k++) {
+/*
+	BrPi[j][k]: \pi iz k-tog ponavljanja s 10^j tocaka.
+	Svaki eksponent je jedan neprekinuti stupac, pa statistika i prilagodba rade izravno nad njim.
+	Ako je zadan zapis, svaka procjena se upisuje u red i odmah zapisuje (u datoteku kosara ili stupaca),
+	a ako je zadana efikasnost, tocke u krugu i ukupne tocke zbrajaju se po eksponentu.
+*/
+vector<vector<double>> Simuliraj(int brPon, int n, int nacin, mt19937_64& gen, RedRezultata* red = nullptr,
+	const function<void()>& zapisi = nullptr, Efikasnost* efikasnost = nullptr)
+{
+	vector<vector<double>> BrPi(n, vector<double>(brPon));
+	for (int k = 0; k < brPon; k++) {
 		for (int j = 0; j < n; j++) {
-			int BrTuKrug = 0;
-			for (int i = 0; i < pow(10, j); i++)
+			long long brTocaka = (long long)pow(10, j);
+			long long BrTuKrug = BrojTocakaUKrugu(brTocaka, nacin, gen);
+			double pi = ((double)BrTuKrug / brTocaka * 4);
+			BrPi[j][k] = pi;
+			if (efikasnost)
+				efikasnost->DodajBrojeve(j, BrTuKrug, brTocaka);
+			if (zapisi)
 			{
-				rand_x = ((double)rand() / (RAND_MAX));
-				rand_y = ((double)rand() / (RAND_MAX));
-				polozaj = pow(rand_x, 2) + pow(rand_y, 2);
-				if (sqrt(polozaj) <= 1)
-					BrTuKrug++;
-
+				*red = { k, j, brTocaka, BrTuKrug, pi };
+				zapisi();
 			}
-			double pi = ((double)BrTuKrug / pow(10, j) * 4);
-			BrPi[k][j] = pi;
 		}
 	}
+	return BrPi;
+}
+
+/*
+	Pita za ime datoteke i sazimanje te otvara pisaca vezanog na red. Uz kosare u obradi > 0
+	sazimanje ide u bazen dretvi (stvara se po potrebi), a uzorkovanje samo kopira vrijednosti.
+	Vraca nullptr ako datoteku nije moguce otvoriti.
+*/
+unique_ptr<PisacRezultata> OtvoriRezultate(RedRezultata& red, unique_ptr<BazenDretvi>& bazen)
+{
+	string ime;
+	PostavkeSazimanja postavke;
+	int alg;
+	size_t maxUObradi;
+	char odg;
+	cout << "Unesi ime datoteke: " << endl;
+	cin >> ime;
+	cout << "Sazimanje (0 - bez, 1 - zstd): " << endl;
+	cin >> alg;
+	postavke.algoritam = alg == 1 ? Algoritam::ZSTD : Algoritam::Bez;
+	if (postavke.algoritam == Algoritam::ZSTD)
+	{
+		if (!ZSTDDostupan())
+			cout << "ZSTD nije preveden (PI2TEST_ZSTD), rezultati ce biti spremljeni nesazeti." << endl;
+		cout << "Unesi razinu sazimanja (1-22): " << endl;
+		cin >> postavke.razina;
+		cout << "Trenirati rjecnik za svaki stupac?(y/n)" << endl;
+		cin >> odg;
+		postavke.rjecnik = odg == 'y';
+	}
+	cout << "Unesi najveci broj kosara u obradi (0 - sazimanje u dretvi uzorkovanja): " << endl;
+	cin >> maxUObradi;
+	if (maxUObradi > 0 && !bazen)
+		bazen.reset(new BazenDretvi());
+
+	try
+	{
+		unique_ptr<PisacRezultata> pisac(new PisacRezultata(ime, postavke, maxUObradi > 0 ? bazen.get() : nullptr, maxUObradi));
+		pisac->Stupac("ponavljanje", &red.ponavljanje);
+		pisac->Stupac("eksponent", &red.eksponent);
+		pisac->Stupac("brTocaka", &red.brTocaka);
+		pisac->Stupac("uKrugu", &red.uKrugu);
+		pisac->Stupac("pi", &red.pi);
+		return pisac;
+	}
+	catch (const exception& e)
+	{
+		cout << "Greska: " << e.what() << endl;
+		return nullptr;
+	}
+}
+
+/*
+	Otvara stupcanu datoteku (bez sazimanja, za citanje mapiranjem) vezanu na red.
+	Vraca nullptr ako datoteku nije moguce otvoriti.
+*/
+unique_ptr<PisacStupaca> OtvoriStupce(RedRezultata& red)
+{
+	string ime;
+	char odg;
+	cout << "Unesi ime datoteke: " << endl;
+	cin >> ime;
+	cout << "Pisati bez medjuspremnika sustava (O_DIRECT)?(y/n)" << endl;
+	cin >> odg;
+	try
+	{
+		unique_ptr<PisacStupaca> pisac(new PisacStupaca(ime, odg == 'y'));
+		pisac->Stupac("ponavljanje", &red.ponavljanje);
+		pisac->Stupac("eksponent", &red.eksponent);
+		pisac->Stupac("brTocaka", &red.brTocaka);
+		pisac->Stupac("uKrugu", &red.uKrugu);
+		pisac->Stupac("pi", &red.pi);
+		return pisac;
+	}
+	catch (const exception& e)
+	{
+		cout << "Greska: " << e.what() << endl;
+		return nullptr;
+	}
+}
+
+void ZatvoriStupce(PisacStupaca& pisac)
+{
+	try
+	{
+		pisac.Zatvori();
+		cout << "Spremljeno " << pisac.BrojRedova() << " redova, " << pisac.BajtovaZapisano() << " bajtova"
+			<< (pisac.BezMedjuspremnika() ? " (bez medjuspremnika sustava)" : "") << endl;
+	}
+	catch (const exception& e)
+	{
+		cout << "Greska: " << e.what() << endl;
+	}
+}
+
+/* Zatvara datoteku rezultata i ispisuje koliko je zapisano */
+void ZatvoriRezultate(PisacRezultata& pisac)
+{
+	try
+	{
+		pisac.Zatvori();
+		cout << "Spremljeno " << pisac.BrojRedova() << " redova, " << pisac.BajtovaZapisano() << " bajtova (nesazeto "
+			<< pisac.BajtovaSirovo() << "), uzorkovanje je cekalo sazimanje " << pisac.SekundeCekanja() << " s" << endl;
+	}
+	catch (const exception& e)
+	{
+		cout << "Greska: " << e.what() << endl;
+	}
+}
+
+/* Eksponent iz ucitane datoteke kao indeks stupca; negativan ili prevelik znaci neispravnu datoteku */
+size_t IndeksEksponenta(int64_t eksponent)
+{
+	const int64_t NAJVECI_EKSPONENT = 64;
+	if (eksponent < 0 || eksponent > NAJVECI_EKSPONENT)
+		throw runtime_error("Neispravan eksponent " + to_string(eksponent));
+	return (size_t)eksponent;
+}
+
+/* \pi-jevi po eksponentu iz izvora: rasponi se obradjuju u bazenu dretvi, svaki utor skuplja svoje, a na kraju se spajaju */
+vector<vector<double>> PiJeviIzIzvora(IzvorPodataka& izvor, BazenDretvi& bazen)
+{
+	if (izvor.Tip("eksponent") != TipStupca::Int64 || izvor.Tip("pi") != TipStupca::Double)
+		throw runtime_error("Stupac eksponent mora biti cijeli broj, a pi realni");
+	unsigned brUtora = bazen.BrojDretvi();
+	izvor.PostaviBrojUtora(brUtora);
+	vector<const int64_t* const*> eksp(brUtora);
+	vector<const double* const*> pi(brUtora);
+	for (unsigned u = 0; u < brUtora; u++)
+	{
+		eksp[u] = CitacStupca<int64_t>(izvor, "eksponent", u);
+		pi[u] = CitacStupca<double>(izvor, "pi", u);
+	}
+	vector<vector<vector<double>>> BrPiUtora(brUtora);
+	ObradiIzvor(izvor, bazen, brUtora, [&](unsigned u, uint64_t) {
+		size_t j = IndeksEksponenta(**eksp[u]);
+		if (j >= BrPiUtora[u].size())
+			BrPiUtora[u].resize(j + 1);
+		BrPiUtora[u][j].push_back(**pi[u]);
+	});
+	vector<vector<double>> BrPi;
+	for (auto& b : BrPiUtora)
+	{
+		if (b.size() > BrPi.size())
+			BrPi.resize(b.size());
+		for (size_t j = 0; j < b.size(); j++)
+			BrPi[j].insert(BrPi[j].end(), b[j].begin(), b[j].end());
+	}
+	return BrPi;
+}
+
+void IspisiSrVrijStDev(const vector<vector<double>>& BrPi)
+{
+	vector<double> srVrij, stDev;
+	SrVrijStDev(BrPi, srVrij, stDev);
+	for (size_t i = 0; i < BrPi.size(); i++)
+		if (!BrPi[i].empty())
+			cout << "Srednja vrijednost i standardna devijacija" << i + 1 << "-tog eksperimenta: " << srVrij[i] << " +- " << stDev[i] << endl;
+}
+
+/* Stupcana datoteka; najmanji i najveci \pi dolaze iz statistike komada, bez citanja podataka */
+vector<vector<double>> UcitajStupce(const string& ime)
+{
+	auto pocetak = chrono::steady_clock::now();
+	IzvorStupaca izvor(ime);
+	BazenDretvi bazen;
+	vector<vector<double>> BrPi = PiJeviIzIzvora(izvor, bazen);
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	const CitacStupaca& citac = izvor.Citac();
+	double piMin = INFINITY, piMax = -INFINITY;
+	int sPi = citac.IndeksStupca("pi");
+	for (uint64_t k = 0; k < citac.BrojKomada(); k++)
+	{
+		double mn, mx;
+		citac.MinMax(sPi, k, mn, mx);
+		piMin = min(piMin, mn);
+		piMax = max(piMax, mx);
+	}
+	cout << "Ucitano " << citac.BrojRedova() << " redova iz " << citac.BrojKomada() << " komada za " << sekunde << " s ("
+		<< bazen.BrojDretvi() << " dretvi), pi u [" << piMin << ", " << piMax << "]" << endl;
+	return BrPi;
+}
+
+/* CSV sa stupcima eksponent i pi (i bilo kojim drugim brojcanim stupcima) */
+vector<vector<double>> UcitajCSV(const string& ime)
+{
+	auto pocetak = chrono::steady_clock::now();
+	BazenDretvi bazen;
+	IzvorCSV izvor(ime, bazen);
+	double sekundeBrojanja = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	vector<vector<double>> BrPi = PiJeviIzIzvora(izvor, bazen);
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	cout << "Ucitano " << izvor.BrojRedova() << " redova iz " << izvor.BrojKomada() << " komada za " << sekunde << " s (brojanje redova "
+		<< sekundeBrojanja << " s, " << bazen.BrojDretvi() << " dretvi)" << endl;
+	return BrPi;
+}
+
+/* Datoteka kosara; sljedece kosare se citaju unaprijed */
+vector<vector<double>> UcitajKosare(const string& ime)
+{
+	auto pocetak = chrono::steady_clock::now();
+	CitacRezultata citac(ime);
+	int sEksp = citac.IndeksStupca("eksponent"), sPi = citac.IndeksStupca("pi");
+	if (sEksp < 0 || sPi < 0)
+		throw runtime_error("Datoteka nema stupce eksponent i pi");
+	/* Po kosarama: raspon oba stupca do kraja krace kosare */
+	citac.ZakaziCitanje({ (size_t)sEksp, (size_t)sPi }, 0, citac.BrojRedova());
+	vector<vector<double>> BrPi;
+	for (uint64_t red = 0; red < citac.BrojRedova();)
+	{
+		RasponStupca<int64_t> eksp = citac.Int64Raspon(sEksp, red);
+		RasponStupca<double> pi = citac.DoubleRaspon(sPi, red);
+		size_t m = min(eksp.n, pi.n);
+		for (size_t i = 0; i < m; i++)
+		{
+			size_t j = IndeksEksponenta(eksp[i]);
+			if (j >= BrPi.size())
+				BrPi.resize(j + 1);
+			BrPi[j].push_back(pi[i]);
+		}
+		red += m;
+	}
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	cout << "Ucitano " << citac.BrojRedova() << " redova za " << sekunde << " s (" << citac.KosaraUnaprijed()
+		<< " kosara procitano unaprijed, cekanje " << citac.SekundeCekanja() << " s)" << endl;
+	return BrPi;
+}
+
+/*
+	Nacin 7: srednje vrijednosti i standardne devijacije iz spremljene datoteke rezultata.
+	Procitani \pi-jevi po eksponentu mogu se spremiti u prirucno spremiste pod sazetkom datoteke,
+	pa ponovljena obrada iste (neizmijenjene) datoteke ne cita i ne parsira datoteku ponovno.
+*/
+void UcitajRezultate()
+{
+	string ime;
+	char odg;
+	cout << "Unesi ime datoteke: " << endl;
+	cin >> ime;
+	cout << "Koristiti prirucno spremiste obrade?(y/n)" << endl;
+	cin >> odg;
+	try
+	{
+		Spremiste spremiste;
+		uint64_t kljuc = SazetakTeksta("nacin 7: pi po eksponentu", SazetakDatoteke(ime));
+		vector<vector<double>> BrPi;
+		auto pocetak = chrono::steady_clock::now();
+		if (odg == 'y' && spremiste.Ucitaj(kljuc, BrPi))
+		{
+			double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+			cout << "Ucitano iz prirucnog spremista " << spremiste.Ime(kljuc) << " za " << sekunde << " s" << endl;
+		}
+		else
+		{
+			if (CitacStupaca::JeStupcana(ime))
+				BrPi = UcitajStupce(ime);
+			else if (ime.size() > 4 && ime.compare(ime.size() - 4, 4, ".csv") == 0)
+				BrPi = UcitajCSV(ime);
+			else
+				BrPi = UcitajKosare(ime);
+			if (odg == 'y')
+				spremiste.Spremi(kljuc, BrPi);
+		}
+		IspisiSrVrijStDev(BrPi);
+	}
+	catch (const exception& e)
+	{
+		cout << "Greska: " << e.what() << endl;
+	}
+}
+
+/* Tekstualni histogram procjena u srVrij +- 4 stDev */
+void IspisiHistogram(const vector<double>& pi, double srVrij, double stDev)
+{
+	const int BR_BINOVA = 20, SIRINA = 50;
+	double pola = stDev > 0 ? 4 * stDev : 1.0;
+	Histogram1D h(BR_BINOVA, srVrij - pola, srVrij + pola);
+	h.FillN(pi.data(), pi.size());
+	double najvise = 0.0;
+	for (int b = 1; b <= BR_BINOVA; b++)
+		najvise = max(najvise, h.Sadrzaj(b));
+	for (int b = 1; b <= BR_BINOVA; b++)
+	{
+		cout << setw(10) << h.SredinaBina(b) << " " << setw(8) << (long long)h.Sadrzaj(b) << " ";
+		int duljina = najvise > 0 ? (int)(SIRINA * h.Sadrzaj(b) / najvise + 0.5) : 0;
+		cout << string(duljina, '*') << endl;
+	}
+	cout << "Izvan raspona: " << (long long)(h.Sadrzaj(0) + h.Sadrzaj(BR_BINOVA + 1)) << ", srednja vrijednost "
+		<< h.SrednjaVrijednost() << " +- " << h.StDev() << endl;
+}
+
+/* Nacini 1-3: tablica \pi-jeva, srednje vrijednosti i standardne devijacije po eksponentu */
+void PiEksperiment(int nacin, mt19937_64& gen)
+{
+	int n, brPon;
+	char odg;
+	vector<vector<double>> BrPi;
+	vector<double> srVrij, stDev;
+
+	cout << "Unesi potenciju: " << endl;
+	cin >> n;
+	brPon = n;
+	if (nacin == 3)
+	{
+		cout << "Unesi broj ponavljanja za usporedbu: " << endl;
+		cin >> brPon;
+	}
+
+	RedRezultata red;
+	unique_ptr<BazenDretvi> bazen;
+	unique_ptr<PisacRezultata> pisac;
+	unique_ptr<PisacStupaca> pisacStupaca;
+	function<void()> zapisi;
+	cout << "Zelite li spremati rezultate u datoteku?(y/n)" << endl;
+	cin >> odg;
+	if (odg == 'y')
+	{
+		int format;
+		cout << "Format datoteke (0 - kosare sa sazimanjem, 1 - stupci za mapiranje): " << endl;
+		cin >> format;
+		if (format == 1)
+		{
+			pisacStupaca = OtvoriStupce(red);
+			if (pisacStupaca)
+				zapisi = [&pisacStupaca] { pisacStupaca->Popuni(); };
+		}
+		else
+		{
+			pisac = OtvoriRezultate(red, bazen);
+			if (pisac)
+				zapisi = [&pisac] { pisac->Popuni(); };
+		}
+	}
+
+	Efikasnost efikasnost(n);
+	BrPi = Simuliraj(brPon, n, nacin == 2 ? 2 : 1, gen, &red, zapisi, &efikasnost);
+	if (pisac)
+		ZatvoriRezultate(*pisac);
+	if (pisacStupaca)
+		ZatvoriStupce(*pisacStupaca);
 	cout << "Zelite li ispisati dobivene pi-jeve?(y/n)" << endl;
 	cin >> odg;
 	if (odg == 'y')
 	{
 		cout << "Skup \pi-jeva dobijen pomocu Monte Carlo metode." << endl;
-		for (int i = 0; i < n; i++)
+		for (int i = 0; i < brPon; i++)
 		{
 			for (int j = 0; j < n; j++)
 			{
-				cout << "(" << i + 1 << ", " << j + 1 << ")-ti \pi je: " << BrPi[i][j] << " ";
+				cout << "(" << i + 1 << ", " << j + 1 << ")-ti \pi je: " << BrPi[j][i] << " ";
 
 			}
 			cout << endl;
@@ -72,44 +467,1054 @@ int main()
 	/*Srednja vrijednost i standardna devijacija*/
 	
 
+	SrVrijStDev(BrPi, srVrij, stDev);
+
 	cout << "Ovdje su srednje vrijednosti po identicnom eksperimentu." << endl;
 	
 	for (int i = 0; i < n; i++)
 	{
-		
-			for (int j = 0; j < n; j++)
-			{
-				srVrij[i] += BrPi[j][i];
-			}
-			srVrij[i] = srVrij[i] / ((double)n);
 	cout << "Srednja vrijednost za " << i + 1 << "-ti eksperiment je: " << srVrij[i] << endl;
 	}
 	
 	cout << "Ovdje su standardne devijacije po identicnom eksperimentu." << endl;
-	/*
-		sqrt(suma(x_i - x_sr)^2/n)
-	*/
+	for(int i = 0; i < n; i++)
+	{
+		cout << "Standardne devijacije " << i + 1 << "-tog eksperimenta: " << stDev[i] << endl;
+	}
+
+	for (int i = 0; i < n; i++) 
+	{
+		cout << "Srednja vrijednost i standardna devijacija" << i + 1 << "-tog eksperimenta: " << srVrij[i] << " +- " << stDev[i] << endl;
+	}
+
+	/* Sva ponavljanja zajedno: \pi = 4 * (tocke u krugu) / (sve tocke), intervali od 1 sigma */
 	for (int i = 0; i < n; i++)
 	{
-		for(int j=0;j<n;j++)
+		Interval cp = efikasnost.IntervalPovjerenja(i, MetodaIntervala::ClopperPearson);
+		Interval w = efikasnost.IntervalPovjerenja(i, MetodaIntervala::Wilson);
+		Interval b = efikasnost.IntervalPovjerenja(i, MetodaIntervala::Bayes);
+		cout << "Ukupno " << i + 1 << "-tog eksperimenta: pi = " << 4 * efikasnost.Omjer(i) << " iz " << efikasnost.Ukupno(i) << " tocaka"
+			<< ", Clopper-Pearson [" << 4 * cp.donja << ", " << 4 * cp.gornja << "]"
+			<< ", Wilson [" << 4 * w.donja << ", " << 4 * w.gornja << "]"
+			<< ", Bayes [" << 4 * b.donja << ", " << 4 * b.gornja << "]" << endl;
+	}
+
+	cout << "Zelite li ispisati histogram pi-jeva najveceg eksponenta?(y/n)" << endl;
+	cin >> odg;
+	if (odg == 'y')
+		IspisiHistogram(BrPi[n - 1], srVrij[n - 1], stDev[n - 1]);
+
+	/* Zakon konvergencije stDev = a * N^-b, ocekivano b = 1/2 */
+	vector<double> brTocaka(n);
+	vector<StupacProcjena> stupci;
+	for (int j = 0; j < n; j++)
+	{
+		brTocaka[j] = pow(10, j);
+		stupci.push_back({ brTocaka[j], BrPi[j].data(), BrPi[j].size() });
+	}
+	RezultatPrilagodbe bin = PrilagodiStDev(brTocaka.data(), stDev.data(), n, brPon);
+	RezultatPrilagodbe ml = PrilagodiML(stupci, PI);
+	if (bin.uspjeh)
+		cout << "Prilagodba stDev = a * N^-b: a = " << bin.a << " +- " << bin.aGr << ", b = " << bin.b << " +- " << bin.bGr
+			<< ", chi2/ndf = " << bin.chi2 << "/" << bin.ndf << endl;
+	if (ml.uspjeh)
+		cout << "Nebinirana prilagodba (ML): a = " << ml.a << " +- " << ml.aGr << ", b = " << ml.b << " +- " << ml.bGr
+			<< " (ocekivano a = " << sqrt(PI * (4 - PI)) << ", b = 0.5)" << endl;
+
+	if (nacin == 3)
+	{
+		/* Ista statistika iz binomnog nacina, pa usporedba razdioba po eksponentu */
+		vector<vector<double>> BrPiBin = Simuliraj(brPon, n, 2, gen);
+		vector<double> srVrijBin, stDevBin;
+		SrVrijStDev(BrPiBin, srVrijBin, stDevBin);
+
+		cout << "Usporedba pune simulacije i binomne provjere po eksponentu." << endl;
+		for (int i = 0; i < n; i++)
 		{
-			stDev[i] += pow(BrPi[j][i] - srVrij[i], 2);
+			double D = 0.0, T = 0.0;
+			double pKS = KSTest2(BrPi[i], BrPiBin[i], &D);
+			double pAD = ADTest2(BrPi[i], BrPiBin[i], &T);
+			cout << i + 1 << "-ti eksperiment: puna " << srVrij[i] << " +- " << stDev[i]
+				<< ", binomna " << srVrijBin[i] << " +- " << stDevBin[i]
+				<< ", KS D = " << D << " (p = " << pKS << ")"
+				<< ", AD T = " << T << " (p = " << pAD << ")" << endl;
 		}
-		stDev[i] = sqrt(stDev[i] / ((double)n));
 	}
-	for(int i = 0; i < n; i++)
+
+}
+
+/* Nacin 5: koeficijenti kontrolnih varijabli koji minimiziraju varijancu procjenitelja \pi */
+void UgadjanjeKontrolnihVarijabli()
+{
+	int potencija, stupanj;
+	unsigned brDretvi;
+	cout << "Unesi potenciju (10^p tocaka po izracunu funkcije cilja): " << endl;
+	cin >> potencija;
+	cout << "Unesi stupanj polinoma kontrolnih varijabli: " << endl;
+	cin >> stupanj;
+	cout << "Unesi broj dretvi za racunanje gradijenta (0 - serijski): " << endl;
+	cin >> brDretvi;
+
+	KontrolneVarijable kv(stupanj, (uint64_t)pow(10, potencija), (uint64_t)time(NULL));
+	vector<double> c(kv.BrojParametara(), 0.0);
+	double var0 = kv(c);
+
+	unique_ptr<BazenDretvi> bazen;
+	if (brDretvi > 0)
+		bazen.reset(new BazenDretvi(brDretvi));
+	auto pocetak = chrono::steady_clock::now();
+	RezultatMinimizacije r = MinimizirajBFGS(FunkcijaCilja(kv), c, bazen.get());
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	cout << "Broj parametara: " << kv.BrojParametara() << ", iteracija: " << r.brIteracija << ", poziva funkcije: " << r.brPoziva
+		<< ", vrijeme: " << sekunde << " s" << (r.konvergirao ? "" : " (nije konvergiralo)") << endl;
+	cout << "Varijanca bez kontrolnih varijabli: " << var0 << ", s kontrolnim varijablama: " << r.f
+		<< ", smanjenje: " << var0 / r.f << " puta" << endl;
+
+	/* Provjera na novom uzorku, da se ne procjenjuje na istim tockama na kojima se ugadjalo */
+	double pi0, v0, pi1, v1;
+	kv.Procijeni(c, kv.sjeme + 1, pi0, v0);
+	kv.Procijeni(r.x, kv.sjeme + 1, pi1, v1);
+	cout << "Novi uzorak: pi = " << pi0 << " +- " << sqrt(v0 / kv.brTocaka) << " (obicno), "
+		<< pi1 << " +- " << sqrt(v1 / kv.brTocaka) << " (kontrolne varijable)" << endl;
+}
+
+/* 10^p tocaka (x,y) iz zadanog generatora */
+template <class G>
+void GenerirajTocke(G g, vector<double>& x, vector<double>& y)
+{
+	for (size_t i = 0; i < x.size(); i++)
 	{
-		cout << "Standardne devijacije " << i + 1 << "-tog eksperimenta: " << stDev[i] << endl;
+		x[i] = Jednolik(g);
+		y[i] = Jednolik(g);
 	}
+}
 
-	for (int i = 0; i < n; i++) 
+/*
+	Nacin 6: prostorna jednolikost tocaka preko udaljenosti do najblizeg susjeda (KD stablo).
+	Za n jednolikih tocaka vrijedi P(D > r) = (1 - \pi r^2)^n za udaljenost od slucajnog mjesta
+	do najblize tocke, pa je u = (1 - \pi D^2)^n jednolik na [0,1) (KS i AD test).
+	Ponovljene tocke (D = 0 izmedju tocaka skupa) otkrivaju resetku slabog generatora.
+*/
+void ProstornaJednolikost()
+{
+	int potencija, izbor;
+	cout << "Unesi potenciju (10^p tocaka): " << endl;
+	cin >> potencija;
+	cout << "Odaberi generator (1 - rand() (MSVC LCG), 2 - minstd_rand, 3 - mt19937_64): " << endl;
+	cin >> izbor;
+
+	size_t n = (size_t)pow(10, potencija);
+	uint32_t sjeme = (uint32_t)time(NULL);
+	vector<double> x(n), y(n);
+	if (izbor == 1)
+		GenerirajTocke(MsvcRand(sjeme), x, y);
+	else if (izbor == 2)
+		GenerirajTocke(minstd_rand(sjeme), x, y);
+	else
+		GenerirajTocke(mt19937_64(sjeme), x, y);
+
+	BazenDretvi bazen;
+	auto pocetak = chrono::steady_clock::now();
+	KDStablo2D stablo(x.data(), y.data(), n, bazen.BrojDretvi());
+	double tGradnja = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	pocetak = chrono::steady_clock::now();
+	vector<double> d2;
+	vector<uint32_t> susjed;
+	stablo.NajbliziSusjedSkupa(d2, susjed, &bazen);
+	double tUpiti = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	/* Srednja udaljenost do susjeda samo za tocke dovoljno daleko od ruba kvadrata (ocekivano 1/(2 sqrt(n))) */
+	double rub = 5.0 / sqrt((double)n), suma = 0.0;
+	size_t brUnutra = 0, brIstih = 0;
+	for (size_t i = 0; i < n; i++)
 	{
-		cout << "Srednja vrijednost i standardna devijacija" << i + 1 << "-tog eksperimenta: " << srVrij[i] << " +- " << stDev[i] << endl;
+		if (d2[i] == 0.0)
+			brIstih++;
+		if (x[i] > rub && x[i] < 1 - rub && y[i] > rub && y[i] < 1 - rub)
+		{
+			suma += sqrt(d2[i]);
+			brUnutra++;
+		}
 	}
 
+	/* Udaljenost od slucajnih mjesta (neovisni generator) do najblize tocke */
+	size_t m = min<size_t>(n, 100000);
+	vector<double> qx(m), qy(m), qd2(m), u(m);
+	vector<uint32_t> qi(m);
+	mt19937_64 genUpit(sjeme + 1);
+	uniform_real_distribution<double> U(rub, 1 - rub);
+	for (size_t i = 0; i < m; i++)
+	{
+		qx[i] = U(genUpit);
+		qy[i] = U(genUpit);
+	}
+	stablo.NajbliziSusjedi(qx.data(), qy.data(), m, 1, qd2.data(), qi.data(), nullptr, &bazen);
+	for (size_t i = 0; i < m; i++)
+		u[i] = pow(max(0.0, 1.0 - PI * qd2[i]), (double)n);
+	double D, A2, pAD;
+	double pKS = KSTestJednolik(u, &D, &A2, &pAD);
+
+	cout << "Gradnja stabla: " << tGradnja << " s, " << n << " upita najblizeg susjeda: " << tUpiti << " s" << endl;
+	cout << "Ponovljenih tocaka: " << brIstih << " (za jednolike tocke ocekivano 0)" << endl;
+	cout << "Srednja udaljenost do najblizeg susjeda: " << (brUnutra ? suma / brUnutra : 0.0)
+		<< " (ocekivano " << 0.5 / sqrt((double)n) << ")" << endl;
+	cout << "Udaljenost slucajnog mjesta do najblize tocke: KS D = " << D << " (p = " << pKS << "), AD A2 = " << A2
+		<< " (p = " << pAD << ")" << endl;
+}
+
+/*
+	Nacin 8: obrtanje poretka bajtova svim skupovima instrukcija koje procesor podrzava.
+	Svaka jezgra se prvo usporedjuje sa skalarnim obrtanjem, pa se mjeri brzina u GB/s.
+*/
+void ObrtanjeBajtova(mt19937_64& gen)
+{
+	int potencija;
+	cout << "Unesi potenciju (10^p bajtova): " << endl;
+	cin >> potencija;
+	size_t bajtova = (size_t)pow(10, potencija);
+	/* Duljina koja nije visekratnik 64 provjerava i skalarni ostatak */
+	bajtova = max<size_t>(bajtova - bajtova % 8 + 8 * 7, 64);
+	vector<uint8_t> izvor(bajtova);
+	for (auto& b : izvor)
+		b = (uint8_t)gen();
+
+	SkupInstrukcija najbolji = NajboljiSkupInstrukcija();
+	cout << "Najbolji skup instrukcija: " << ImeSkupa(najbolji) << endl;
+	size_t sirine[] = { 2, 4, 8 };
+	for (size_t w : sirine)
+	{
+		size_t n = bajtova / w;
+		vector<uint8_t> ocekivano(izvor);
+		for (size_t i = 0; i < n; i++)
+			reverse(ocekivano.begin() + i * w, ocekivano.begin() + (i + 1) * w);
+
+		for (int s = 0; s <= (int)najbolji; s++)
+		{
+			SkupInstrukcija skup = (SkupInstrukcija)s;
+			vector<uint8_t> podaci(izvor);
+			ObrniBajtoveNiza(podaci.data(), n, w, skup);
+			bool ispravno = podaci == ocekivano;
+
+			int brPon = max(1, (int)(1e9 / bajtova));
+			auto pocetak = chrono::steady_clock::now();
+			for (int k = 0; k < brPon; k++)
+				ObrniBajtoveNiza(podaci.data(), n, w, skup);
+			double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+			cout << w << "-bajtne vrijednosti, " << ImeSkupa(skup) << ": " << (ispravno ? "ispravno" : "NEISPRAVNO")
+				<< ", " << (double)bajtova * brPon / sekunde / 1e9 << " GB/s" << endl;
+		}
+	}
+}
+
+/*
+	Nacin 9: punjenje histograma procjena \pi jednu po jednu (Fill) i u nizu (FillN).
+	Sadrzaj oba histograma mora biti jednak; ispisuje se brzina i ubrzanje.
+*/
+void BrzinaHistograma(mt19937_64& gen)
+{
+	int potencija;
+	cout << "Unesi potenciju (10^p vrijednosti): " << endl;
+	cin >> potencija;
+	size_t n = (size_t)pow(10, potencija);
+	normal_distribution<double> N(PI, 0.05);
+	uniform_real_distribution<double> U(0.5, 1.5);
+	vector<double> x(n), w(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		x[i] = N(gen);
+		w[i] = U(gen);
+	}
+
+	for (int tezine = 0; tezine < 2; tezine++)
+	{
+		const double* pw = tezine ? w.data() : nullptr;
+		Histogram1D jedan(100, PI - 0.2, PI + 0.2), niz(100, PI - 0.2, PI + 0.2);
+		auto pocetak = chrono::steady_clock::now();
+		for (size_t i = 0; i < n; i++)
+			jedan.Fill(x[i], pw ? pw[i] : 1.0);
+		double tJedan = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+		pocetak = chrono::steady_clock::now();
+		niz.FillN(x.data(), n, pw);
+		double tNiz = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+		bool jednako = true;
+		for (int b = 0; b <= 101; b++)
+			jednako = jednako && fabs(jedan.Sadrzaj(b) - niz.Sadrzaj(b)) <= 1e-9 * max(1.0, jedan.Sadrzaj(b));
+		jednako = jednako && fabs(jedan.SrednjaVrijednost() - niz.SrednjaVrijednost()) < 1e-9 && fabs(jedan.StDev() - niz.StDev()) < 1e-9;
+		cout << (tezine ? "S tezinama: " : "Bez tezina: ") << (jednako ? "isti sadrzaj" : "RAZLICIT SADRZAJ")
+			<< ", Fill " << n / tJedan / 1e6 << " M/s, FillN " << n / tNiz / 1e6 << " M/s, ubrzanje " << tJedan / tNiz << endl;
+	}
+
+	/* Rijetki 5D histogram (ponavljanje, eksponent, dretva, procjenitelj, \pi) prema gustom polju istih binova */
+	vector<HistogramRijetki::Os> osi = { { 20, 0, 20 }, { 8, 0, 8 }, { 4, 0, 4 }, { 4, 0, 4 }, { 200, PI - 0.15, PI + 0.15 } };
+	const size_t DIM = 5;
+	vector<double> tocke(DIM * n);
+	uniform_int_distribution<int> B20(0, 19), B8(0, 7), B4(0, 3);
+	normal_distribution<double> Npi(PI, 0.01);
+	for (size_t i = 0; i < n; i++)
+	{
+		tocke[DIM * i] = B20(gen);
+		tocke[DIM * i + 1] = B8(gen);
+		tocke[DIM * i + 2] = B4(gen);
+		tocke[DIM * i + 3] = B4(gen);
+		tocke[DIM * i + 4] = Npi(gen);
+	}
+
+	size_t brGustih = 1;
+	for (const auto& o : osi)
+		brGustih *= o.brBinova + 2;
+	vector<double> gusti(brGustih, 0.0);
+	auto pocetak = chrono::steady_clock::now();
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t indeks = 0;
+		for (size_t d = 0; d < DIM; d++)
+			indeks = indeks * (osi[d].brBinova + 2) + BinJednakeSirine(tocke[DIM * i + d], osi[d].min, osi[d].brBinova / (osi[d].max - osi[d].min), osi[d].brBinova);
+		gusti[indeks] += 1.0;
+	}
+	double tGusti = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	HistogramRijetki jedan(osi), niz(osi), spojeni(osi);
+	pocetak = chrono::steady_clock::now();
+	for (size_t i = 0; i < n; i++)
+		jedan.Fill(&tocke[DIM * i]);
+	double tJedan = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	pocetak = chrono::steady_clock::now();
+	niz.FillN(tocke.data(), n);
+	double tNiz = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	/* Svaka dretva puni svoj histogram, pa se zbrajaju */
+	unsigned brDretvi = max(1u, thread::hardware_concurrency());
+	vector<HistogramRijetki> poDretvama(brDretvi, HistogramRijetki(osi));
+	vector<thread> dretve;
+	pocetak = chrono::steady_clock::now();
+	for (unsigned t = 0; t < brDretvi; t++)
+		dretve.emplace_back([&, t] {
+			size_t od = n * t / brDretvi, doo = n * (t + 1) / brDretvi;
+			poDretvama[t].FillN(tocke.data() + DIM * od, doo - od);
+		});
+	for (auto& d : dretve)
+		d.join();
+	for (const auto& h : poDretvama)
+		spojeni.Dodaj(h);
+	double tDretve = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+
+	bool jednako = jedan.BrojPopunjenih() == niz.BrojPopunjenih() && niz.BrojPopunjenih() == spojeni.BrojPopunjenih();
+	size_t brNeprazih = 0;
+	for (double c : gusti)
+		brNeprazih += c != 0.0;
+	jednako = jednako && brNeprazih == niz.BrojPopunjenih();
+	niz.ZaSvakiBin([&](const int* binovi, double sumw, double) {
+		size_t indeks = 0;
+		for (size_t d = 0; d < DIM; d++)
+			indeks = indeks * (osi[d].brBinova + 2) + binovi[d];
+		jednako = jednako && gusti[indeks] == sumw && jedan.Sadrzaj(binovi) == sumw && spojeni.Sadrzaj(binovi) == sumw;
+	});
+	cout << "Rijetki 5D: " << (jednako ? "isti sadrzaj kao gusti" : "RAZLICIT SADRZAJ") << ", popunjeno " << niz.BrojPopunjenih()
+		<< " od " << brGustih << " binova, " << niz.BajtovaMemorije() << " B (gusti " << brGustih * sizeof(double) << " B)" << endl;
+	cout << "Gusti " << n / tGusti / 1e6 << " M/s, rijetki Fill " << n / tJedan / 1e6 << " M/s, FillN " << n / tNiz / 1e6
+		<< " M/s, " << brDretvi << " dretvi sa zbrajanjem " << n / tDretve / 1e6 << " M/s" << endl;
+}
+
+/*
+	Dretve koje istovremeno uzimaju i vracaju utore iz skupa; utor ne smije biti u dvije dretve odjednom.
+	Vraca nanosekunde po paru Uzmi/Vrati.
+*/
+template <class S>
+double MjeriUtore(unsigned brDretvi, size_t brPonavljanja, bool& ispravno)
+{
+	struct alignas(64) Zauzet
+	{
+		atomic<int> da{ 0 };
+	};
+	S skup(brDretvi);
+	vector<Zauzet> zauzet(brDretvi);
+	atomic<bool> greska{ false };
+	vector<thread> dretve;
+	auto pocetak = chrono::steady_clock::now();
+	for (unsigned t = 0; t < brDretvi; t++)
+		dretve.emplace_back([&] {
+			for (size_t i = 0; i < brPonavljanja; i++)
+			{
+				unsigned u = skup.Uzmi();
+				if (zauzet[u].da.exchange(1, memory_order_relaxed) != 0)
+					greska = true;
+				zauzet[u].da.store(0, memory_order_relaxed);
+				skup.Vrati(u);
+			}
+		});
+	for (auto& d : dretve)
+		d.join();
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	ispravno = !greska;
+	return sekunde * 1e9 / brPonavljanja;
+}
+
+/* Nacin 10: stog utora pod mutexom prema skupu utora bez zakljucavanja */
+void BrzinaUtora()
+{
+	unsigned brDretvi;
+	size_t brPonavljanja;
+	cout << "Unesi broj dretvi: " << endl;
+	cin >> brDretvi;
+	cout << "Unesi broj uzimanja utora po dretvi: " << endl;
+	cin >> brPonavljanja;
+	brDretvi = max(1u, brDretvi);
+	bool ispravnoStog, ispravnoSkup;
+	double nsStog = MjeriUtore<StogUtora>(brDretvi, brPonavljanja, ispravnoStog);
+	double nsSkup = MjeriUtore<SkupUtora>(brDretvi, brPonavljanja, ispravnoSkup);
+	cout << brDretvi << " dretvi: mutex " << nsStog << " ns, bez zakljucavanja " << nsSkup << " ns po uzimanju i vracanju (ubrzanje "
+		<< nsStog / nsSkup << ")" << (ispravnoStog && ispravnoSkup ? "" : ", UTOR DIJELJEN IZMEDJU DRETVI") << endl;
+}
+
+/*
+	Tocke iz stupaca x i y izvora; svaki utor broji svoje tocke u krugu, red po red ili u blokovima
+	s maskom (Filter x*x + y*y <= 1, Count). Vraca broj tocaka u krugu i sekunde.
+*/
+pair<uint64_t, double> TockeUKruguIzvora(IzvorPodataka& izvor, BazenDretvi& bazen, bool blokovi)
+{
+	auto pocetak = chrono::steady_clock::now();
+	unsigned brDretvi = bazen.BrojDretvi();
+	izvor.PostaviBrojUtora(brDretvi);
+	struct alignas(64) Brojac
+	{
+		uint64_t uKrugu = 0;
+		MaskaBloka maska;
+	};
+	vector<Brojac> brojaci(brDretvi);
+	vector<const double* const*> x(brDretvi), y(brDretvi);
+	for (unsigned u = 0; u < brDretvi; u++)
+	{
+		x[u] = CitacStupca<double>(izvor, "x", u);
+		y[u] = CitacStupca<double>(izvor, "y", u);
+	}
+	if (blokovi)
+		ObradiIzvorBlokovima(izvor, bazen, brDretvi, [&](unsigned u, uint64_t, size_t n) {
+			const double *a = *x[u], *b = *y[u];
+			MaskaBloka& m = brojaci[u].maska;
+			m.Pocni(n);
+			m.Filtriraj([a, b](size_t i) { return a[i] * a[i] + b[i] * b[i] <= 1.0; });
+			brojaci[u].uKrugu += m.Broj();
+		});
+	else
+		ObradiIzvor(izvor, bazen, brDretvi, [&](unsigned u, uint64_t) {
+			double a = **x[u], b = **y[u];
+			brojaci[u].uKrugu += a * a + b * b <= 1.0;
+		});
+	uint64_t uKrugu = 0;
+	for (const Brojac& b : brojaci)
+		uKrugu += b.uKrugu;
+	return { uKrugu, chrono::duration<double>(chrono::steady_clock::now() - pocetak).count() };
+}
+
+pair<uint64_t, double> TockeUKruguPhilox(uint64_t brTocaka, uint64_t sjeme, unsigned brDretvi, bool blokovi)
+{
+	IzvorSlucajni izvor(brTocaka);
+	izvor.DefinirajJednoliki("x", 0.0, 1.0, sjeme);
+	izvor.DefinirajSlucajni("y", uniform_real_distribution<double>(0.0, 1.0), sjeme);
+	BazenDretvi bazen(brDretvi);
+	return TockeUKruguIzvora(izvor, bazen, blokovi);
+}
+
+/*
+	Nacin 11: \pi iz generatora s brojacem; rezultat mora biti isti s jednom dretvom i s vise njih,
+	red po red i u blokovima. Zatim ista obrada nad stupcima u memoriji, gdje se vidi cijena poziva po redu.
+*/
+void PonovljivaSimulacija()
+{
+	int potencija;
+	uint64_t sjeme;
+	unsigned brDretvi;
+	cout << "Unesi potenciju (10^p tocaka): " << endl;
+	cin >> potencija;
+	cout << "Unesi sjeme: " << endl;
+	cin >> sjeme;
+	cout << "Unesi broj dretvi: " << endl;
+	cin >> brDretvi;
+	brDretvi = max(1u, brDretvi);
+	uint64_t n = (uint64_t)pow(10, potencija);
+	pair<uint64_t, double> jedna = TockeUKruguPhilox(n, sjeme, 1, false);
+	pair<uint64_t, double> vise = TockeUKruguPhilox(n, sjeme, brDretvi, false);
+	pair<uint64_t, double> blokovi = TockeUKruguPhilox(n, sjeme, brDretvi, true);
+	cout << "1 dretva: " << jedna.first << " u krugu, pi = " << 4.0 * jedna.first / n << ", " << n / jedna.second / 1e6 << " M/s" << endl;
+	cout << brDretvi << " dretvi: " << vise.first << " u krugu, pi = " << 4.0 * vise.first / n << ", " << n / vise.second / 1e6 << " M/s" << endl;
+	cout << brDretvi << " dretvi u blokovima: " << blokovi.first << " u krugu, " << n / blokovi.second / 1e6 << " M/s" << endl;
+	cout << (jedna.first == vise.first && vise.first == blokovi.first ? "Rezultati su isti" : "REZULTATI SE RAZLIKUJU") << endl;
+
+	/* Stupci u memoriji: bez generiranja ostaje samo obrada, red po red prema blokovima */
+	size_t m = (size_t)min<uint64_t>(n, 10000000);
+	vector<double> x(m), y(m);
+	for (size_t i = 0; i < m; i++)
+	{
+		Philox gx(sjeme, i, 0), gy(sjeme, i, 1);
+		x[i] = gx.U01();
+		y[i] = gy.U01();
+	}
+	IzvorMemorije memorija;
+	memorija.Stupac("x", x);
+	memorija.Stupac("y", y);
+	BazenDretvi bazen(brDretvi);
+	pair<uint64_t, double> poRedu = TockeUKruguIzvora(memorija, bazen, false);
+	pair<uint64_t, double> uBlokovima = TockeUKruguIzvora(memorija, bazen, true);
+	cout << "Stupci u memoriji (" << m << " redova): red po red " << m / poRedu.second / 1e6 << " M/s, u blokovima " << m / uBlokovima.second / 1e6
+		<< " M/s, ubrzanje " << poRedu.second / uBlokovima.second << (poRedu.first == uBlokovima.first ? "" : ", RAZLICIT BROJ") << endl;
+}
+
+typedef vector<double, BrojeciAlokator<double>> VektorBrojeci;
+
+/* Izraz po redu nad \pi-jevima jednog ponavljanja: zbroj kvadrata odstupanja bliskih \pi-jeva i zbroj korijena */
+double IzrazStd(const double* p, size_t k)
+{
+	VektorBrojeci v(p, p + k), d(k), d2(k), blizu, korijeni(k);
+	for (size_t i = 0; i < k; i++)
+		d[i] = v[i] - PI;
+	for (size_t i = 0; i < k; i++)
+		d2[i] = d[i] * d[i];
+	for (double x : d2)
+		if (x < 0.01)
+			blizu.push_back(x);
+	for (size_t i = 0; i < k; i++)
+		korijeni[i] = sqrt(v[i]);
+	double s = 0.0, sk = 0.0;
+	for (double x : blizu)
+		s += x;
+	for (double x : korijeni)
+		sk += x;
+	return s + sk;
+}
+
+template <size_t N>
+double IzrazMali(const double* p, size_t k, Arena* arena)
+{
+	MaliVektor<double, N> v(arena);
+	v.resize(k);
+	memcpy(v.data(), p, k * sizeof(double));
+	MaliVektor<double, N> d = v - PI;
+	MaliVektor<double, N> blizu = Filter(d * d, [](double x) { return x < 0.01; });
+	return Sum(blizu) + Sum(Map(v, [](double x) { return sqrt(x); }));
+}
+
+/* Nacin 12: izrazi nad kratkim nizovima po redu sa std::vector i s malim vektorom (bez i s arenom) */
+void BrzinaMalihVektora(mt19937_64& gen)
+{
+	const size_t N = 16;
+	size_t k, brRedova;
+	cout << "Unesi duljinu niza po redu (mali vektor drzi " << N << " u sebi): " << endl;
+	cin >> k;
+	cout << "Unesi broj redova: " << endl;
+	cin >> brRedova;
+	normal_distribution<double> D(PI, 0.1);
+	vector<double> podaci(k * brRedova);
+	for (double& x : podaci)
+		x = D(gen);
+
+	double zbroj[3] = {};
+	double sekunde[3];
+	uint64_t alokacija[3];
+	Arena arena;
+	for (int nacin = 0; nacin < 3; nacin++)
+	{
+		uint64_t prije = BrojAlokacijaGomile();
+		auto pocetak = chrono::steady_clock::now();
+		for (size_t r = 0; r < brRedova; r++)
+		{
+			const double* p = podaci.data() + r * k;
+			if (nacin == 0)
+				zbroj[nacin] += IzrazStd(p, k);
+			else if (nacin == 1)
+				zbroj[nacin] += IzrazMali<N>(p, k, nullptr);
+			else
+			{
+				zbroj[nacin] += IzrazMali<N>(p, k, &arena);
+				arena.Resetiraj();
+			}
+		}
+		sekunde[nacin] = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+		alokacija[nacin] = BrojAlokacijaGomile() - prije;
+	}
+	const char* imena[3] = { "std::vector", "mali vektor", "mali vektor s arenom" };
+	for (int nacin = 0; nacin < 3; nacin++)
+		cout << imena[nacin] << ": " << sekunde[nacin] * 1e9 / brRedova << " ns i " << (double)alokacija[nacin] / brRedova
+			<< " alokacija po redu" << endl;
+	bool isti = fabs(zbroj[0] - zbroj[1]) <= 1e-12 * fabs(zbroj[0]) && fabs(zbroj[0] - zbroj[2]) <= 1e-12 * fabs(zbroj[0]);
+	cout << (isti ? "Rezultati su isti" : "REZULTATI SE RAZLIKUJU") << ", arena ima " << arena.BrojBlokova() << " blokova" << endl;
+
+	/* Pogoci x*x + y*y <= 1 nad dugim nizovima: svaki operator u svoj vektor prema jednoj spojenoj petlji */
+	size_t m = k * brRedova / 2;
+	uniform_real_distribution<double> U(0.0, 1.0);
+	MaliVektor<double, N> x, y;
+	x.resize(m);
+	y.resize(m);
+	for (size_t i = 0; i < m; i++)
+	{
+		x[i] = U(gen);
+		y[i] = U(gen);
+	}
+	uint64_t prije = BrojAlokacijaGomile();
+	auto pocetak = chrono::steady_clock::now();
+	MaliVektor<double, N> xx = x * x, yy = y * y, r2 = xx + yy;
+	MaliVektor<bool, N> uKrugu = r2 <= 1.0;
+	MaliVektor<double, N> xUKrugu = Gdje(uKrugu, x, 0.0);
+	int pogodaka = Sum(uKrugu);
+	double zbrojX = Sum(xUKrugu);
+	double tPrivremeni = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	uint64_t alokacijaPrivremeni = BrojAlokacijaGomile() - prije;
+
+	prije = BrojAlokacijaGomile();
+	pocetak = chrono::steady_clock::now();
+	int pogodakaSpojeno = Sum(x * x + y * y <= 1.0);
+	double zbrojXSpojeno = Sum(Gdje(x * x + y * y <= 1.0, x, 0.0));
+	double tSpojeno = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	uint64_t alokacijaSpojeno = BrojAlokacijaGomile() - prije;
+	cout << "Pogoci nad " << m << " tocaka: s privremenim vektorima " << tPrivremeni * 1e9 / m << " ns/tocki (" << alokacijaPrivremeni
+		<< " alokacija), spojeno " << tSpojeno * 1e9 / m << " ns/tocki (" << alokacijaSpojeno << " alokacija), ubrzanje " << tPrivremeni / tSpojeno << endl;
+	cout << "pi = " << 4.0 * pogodakaSpojeno / m << ", "
+		<< (pogodaka == pogodakaSpojeno && fabs(zbrojX - zbrojXSpojeno) <= 1e-12 * fabs(zbrojX) ? "isti rezultati" : "RAZLICITI REZULTATI") << endl;
+}
+
+/* Posao promjenjive duljine: svaki 64. element je 200 puta skuplji od ostalih */
+double NeujednacenPosao(size_t i)
+{
+	int koraka = i % 64 == 0 ? 4000 : 20;
+	double x = (double)(i % 1000) * 1e-3;
+	for (int k = 0; k < koraka; k++)
+		x = x * 0.999 + 1e-3;
+	return x;
+}
+
+/* Stablo zadataka: svaki cvor salje dva podzadatka i ceka ih, list radi mali posao */
+double StabloZadataka(BazenDretvi& bazen, int dubina, size_t indeks)
+{
+	if (dubina == 0)
+		return NeujednacenPosao(indeks);
+	future<double> lijevo = bazen.Posalji([&bazen, dubina, indeks] { return StabloZadataka(bazen, dubina - 1, 2 * indeks); });
+	double desno = StabloZadataka(bazen, dubina - 1, 2 * indeks + 1);
+	return bazen.Pricekaj(lijevo) + desno;
+}
+
+/* Nacin 13: zajednicki red prema kradji posla (bez i s prikvacenim dretvama) i stope kradje */
+void BrzinaRasporeda()
+{
+	unsigned brDretvi;
+	size_t n;
+	cout << "Unesi broj dretvi: " << endl;
+	cin >> brDretvi;
+	cout << "Unesi broj elemenata: " << endl;
+	cin >> n;
+	brDretvi = max(1u, brDretvi);
+	n = max<size_t>(1, n);
+	int dubina = 0;
+	while (((size_t)2 << dubina) <= n)
+		dubina++;
+
+	const char* imena[3] = { "zajednicki red", "kradja posla", "kradja posla, prikvacene dretve" };
+	double rezultati[3][3];
+	for (int nacin = 0; nacin < 3; nacin++)
+	{
+		BazenDretvi bazen(brDretvi, nacin == 0 ? RasporedDretvi::ZajednickiRed : RasporedDretvi::KradjaPosla, nacin == 2);
+		cout << imena[nacin] << ":" << endl;
+		for (int test = 0; test < 3; test++)
+		{
+			bazen.ResetirajStatistiku();
+			auto pocetak = chrono::steady_clock::now();
+			string opis;
+			if (test == 0)
+			{
+				rezultati[nacin][test] = bazen.MapReduce(n, NeujednacenPosao, 0.0, plus<double>());
+				opis = "MapReduce, komad " + to_string(bazen.ZadnjiKomad());
+			}
+			else if (test == 1)
+			{
+				vector<future<double>> gotovi;
+				for (size_t i = 0; i < n; i++)
+					gotovi.push_back(bazen.Posalji([i] { return NeujednacenPosao(i); }));
+				double s = 0.0;
+				for (auto& g : gotovi)
+					s += g.get();
+				rezultati[nacin][test] = s;
+				opis = "zadatak po elementu";
+			}
+			else
+			{
+				rezultati[nacin][test] = bazen.Posalji([&bazen, dubina] { return StabloZadataka(bazen, dubina, 0); }).get();
+				opis = "stablo dubine " + to_string(dubina);
+			}
+			double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - pocetak).count();
+			uint64_t izvrseno = 0, ukradeno = 0, pokusaja = 0, najvise = 0, najmanje = UINT64_MAX;
+			for (const StatistikaRadnika& s : bazen.Statistika())
+			{
+				izvrseno += s.izvrseno;
+				ukradeno += s.ukradeno;
+				pokusaja += s.pokusajaKradje;
+				najvise = max(najvise, s.izvrseno);
+				najmanje = min(najmanje, s.izvrseno);
+			}
+			cout << "  " << opis << ": " << ms << " ms, " << izvrseno << " zadataka (po dretvi " << najmanje << " - " << najvise << ")";
+			if (nacin > 0)
+				cout << ", ukradeno " << 100.0 * ukradeno / max<uint64_t>(1, izvrseno) << "% uz " << pokusaja << " pokusaja kradje";
+			cout << endl;
+		}
+		if (nacin == 2)
+		{
+			cout << "  dretve na procesorima (cvor):";
+			for (const StatistikaRadnika& s : bazen.Statistika())
+				cout << " " << s.cpu << " (" << s.cvor << ")";
+			cout << endl;
+		}
+	}
+	bool isti = true;
+	for (int nacin = 1; nacin < 3; nacin++)
+		for (int test = 0; test < 3; test++)
+			isti = isti && fabs(rezultati[nacin][test] - rezultati[0][test]) <= 1e-9 * fabs(rezultati[0][test]);
+	cout << (isti ? "Rezultati su isti" : "REZULTATI SE RAZLIKUJU") << endl;
+}
+
+/* Zajednicko stanje cjevovoda: stupanj statistike i kontrolne tocke pisu pod mutexom */
+struct StanjeCjevovoda
+{
+	mutex m;
+	uint64_t uKrugu = 0;
+	double zbrojPi = 0.0, zbrojPi2 = 0.0;
+	vector<uint64_t> kontrolne;
+	chrono::steady_clock::time_point pocetak, prvi;
+};
+
+/* Stupnjevi cjevovoda za komad c od m tocaka */
+vector<double> GenerirajKomad(uint64_t sjeme, size_t c, size_t m)
+{
+	vector<double> r2(m);
+	for (size_t i = 0; i < m; i++)
+	{
+		Philox g(sjeme, (uint64_t)c * m + i);
+		double x = g.U01(), y = g.U01();
+		r2[i] = x * x + y * y;
+	}
+	return r2;
+}
+
+uint64_t ReducirajKomad(const vector<double>& r2)
+{
+	uint64_t u = 0;
+	for (double d : r2)
+		u += d <= 1.0;
+	return u;
+}
+
+double AzurirajStatistiku(StanjeCjevovoda& s, uint64_t u, size_t m)
+{
+	double pi = 4.0 * u / m;
+	lock_guard<mutex> l(s.m);
+	s.uKrugu += u;
+	s.zbrojPi += pi;
+	s.zbrojPi2 += pi * pi;
+	return pi;
+}
+
+void KontrolnaTocka(StanjeCjevovoda& s)
+{
+	lock_guard<mutex> l(s.m);
+	if (s.kontrolne.empty())
+		s.prvi = chrono::steady_clock::now();
+	s.kontrolne.push_back(s.uKrugu);
+}
+
+#ifdef BUDUCNOST_KORUTINE
+Buducnost<void> KomadKorutinom(BazenDretvi& bazen, StanjeCjevovoda& s, uint64_t sjeme, size_t c, size_t m)
+{
+	vector<double> r2 = co_await Asinkrono(bazen, [=] { return GenerirajKomad(sjeme, c, m); });
+	uint64_t u = co_await Asinkrono(bazen, [&r2] { return ReducirajKomad(r2); });
+	co_await Asinkrono(bazen, [&s, u, m] { AzurirajStatistiku(s, u, m); });
+	co_await Asinkrono(bazen, [&s] { KontrolnaTocka(s); });
+}
+#endif
+
+/*
+	Nacin 14: cjevovod generiraj -> reduciraj -> statistika -> kontrolna tocka po komadu. S blokirajucim
+	std::future svaki stupanj zauzima dretvu dok ceka prethodni; s nastavcima (i korutinama, ako ih
+	prevoditelj podrzava) stupanj krece tek kad je prethodni gotov.
+*/
+void BrzinaCjevovoda()
+{
+	unsigned brDretvi;
+	size_t brKomada, m;
+	uint64_t sjeme;
+	cout << "Unesi broj dretvi: " << endl;
+	cin >> brDretvi;
+	cout << "Unesi broj komada: " << endl;
+	cin >> brKomada;
+	cout << "Unesi broj tocaka po komadu: " << endl;
+	cin >> m;
+	cout << "Unesi sjeme: " << endl;
+	cin >> sjeme;
+	brDretvi = max(1u, brDretvi);
+	m = max<size_t>(1, m);
+
+#ifdef BUDUCNOST_KORUTINE
+	const int brNacina = 3;
+#else
+	const int brNacina = 2;
+#endif
+	const char* imena[3] = { "blokirajuci std::future", "nastavci (Then, KadSvi)", "korutine (co_await)" };
+	uint64_t uKrugu[3];
+	for (int nacin = 0; nacin < brNacina; nacin++)
+	{
+		/* Uz kradju posla nastavak ide u red dretve koja je zavrsila prethodni stupanj i izvrsava se sljedeci */
+		BazenDretvi bazen(brDretvi, nacin == 0 ? RasporedDretvi::ZajednickiRed : RasporedDretvi::KradjaPosla);
+		StanjeCjevovoda s;
+		s.pocetak = chrono::steady_clock::now();
+		if (nacin == 0)
+		{
+			/* Zajednicki red je FIFO, pa stupanj ceka samo zadatke koji su vec uzeti, i nema potpunog zastoja */
+			vector<future<void>> kraj;
+			for (size_t c = 0; c < brKomada; c++)
+			{
+				auto gen = make_shared<future<vector<double>>>(bazen.Posalji([=] { return GenerirajKomad(sjeme, c, m); }));
+				auto red = make_shared<future<uint64_t>>(bazen.Posalji([gen] { return ReducirajKomad(gen->get()); }));
+				auto stat = make_shared<future<double>>(bazen.Posalji([red, &s, m] { return AzurirajStatistiku(s, red->get(), m); }));
+				kraj.push_back(bazen.Posalji([stat, &s] {
+					stat->get();
+					KontrolnaTocka(s);
+				}));
+			}
+			for (auto& k : kraj)
+				k.get();
+		}
+		else if (nacin == 1)
+		{
+			vector<Buducnost<void>> kraj;
+			for (size_t c = 0; c < brKomada; c++)
+				kraj.push_back(Asinkrono(bazen, [=] { return GenerirajKomad(sjeme, c, m); })
+					.Then([](const vector<double>& r2) { return ReducirajKomad(r2); })
+					.Then([&s, m](uint64_t u) { return AzurirajStatistiku(s, u, m); })
+					.Then([&s](double) { KontrolnaTocka(s); }));
+			KadSvi(kraj).Get();
+		}
+#ifdef BUDUCNOST_KORUTINE
+		else
+		{
+			vector<Buducnost<void>> kraj;
+			for (size_t c = 0; c < brKomada; c++)
+				kraj.push_back(KomadKorutinom(bazen, s, sjeme, c, m));
+			KadSvi(kraj).Get();
+		}
+#endif
+		auto sad = chrono::steady_clock::now();
+		uKrugu[nacin] = s.uKrugu;
+		double srednji = s.zbrojPi / brKomada, stDev = sqrt(max(0.0, s.zbrojPi2 / brKomada - srednji * srednji));
+		cout << imena[nacin] << ": " << chrono::duration<double, milli>(sad - s.pocetak).count() << " ms, prvi komad gotov nakon "
+			<< chrono::duration<double, milli>(s.prvi - s.pocetak).count() << " ms, pi = " << 4.0 * s.uKrugu / (brKomada * m)
+			<< " (st. dev. komada " << stDev << ")" << endl;
+	}
+	bool isti = true;
+	for (int nacin = 1; nacin < brNacina; nacin++)
+		isti = isti && uKrugu[nacin] == uKrugu[0];
+	cout << (isti ? "Rezultati su isti" : "REZULTATI SE RAZLIKUJU") << endl;
+}
+
+/*
+	Nacin 15: histogram koji pune sve dretve. Zajednicki histogram pod mutexom prema kopiji po dretvi
+	(ObjektPoDretvi) sa spajanjem na kraju (redom i u parovima usporedo) i sa spajanjem tijekom
+	punjenja (Predaj). Dretva i dobiva (i + 1) dijelova posla, pa brze dretve predaju ranije.
+*/
+void BrzinaObjektaPoDretvi()
+{
+	unsigned brDretvi;
+	int brBinova, potencija;
+	cout << "Unesi broj dretvi: " << endl;
+	cin >> brDretvi;
+	cout << "Unesi broj binova: " << endl;
+	cin >> brBinova;
+	cout << "Unesi potenciju (10^p vrijednosti): " << endl;
+	cin >> potencija;
+	brDretvi = max(1u, brDretvi);
+	brBinova = max(1, brBinova);
+	uint64_t n = (uint64_t)pow(10, potencija);
+	auto vrijednost = [](uint64_t i) { return Philox(7, i).U01(); };
+	/* Granice raspona dretve d: dretva d dobiva (d + 1) od brDretvi * (brDretvi + 1) / 2 dijelova */
+	vector<uint64_t> granice(brDretvi + 1, 0);
+	for (unsigned d = 0; d < brDretvi; d++)
+		granice[d + 1] = n * ((uint64_t)(d + 1) * (d + 2) / 2) / ((uint64_t)brDretvi * (brDretvi + 1) / 2);
+
+	Histogram1D referentni(brBinova, 0.0, 1.0);
+	for (uint64_t i = 0; i < n; i++)
+		referentni.Fill(vrijednost(i));
+	auto isti = [&](const Histogram1D& h) {
+		bool jednako = h.BrojUnosa() == referentni.BrojUnosa();
+		for (int b = 0; b <= brBinova + 1; b++)
+			jednako = jednako && h.Sadrzaj(b) == referentni.Sadrzaj(b);
+		return jednako;
+	};
+
+	BazenDretvi bazen(brDretvi);
+	{
+		Histogram1D zajednicki(brBinova, 0.0, 1.0);
+		mutex m;
+		auto pocetak = chrono::steady_clock::now();
+		vector<future<void>> gotovi;
+		for (unsigned d = 0; d < brDretvi; d++)
+			gotovi.push_back(bazen.Posalji([&, d] {
+				for (uint64_t i = granice[d]; i < granice[d + 1]; i++)
+				{
+					double x = vrijednost(i);
+					lock_guard<mutex> l(m);
+					zajednicki.Fill(x);
+				}
+			}));
+		for (auto& g : gotovi)
+			g.get();
+		double s = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+		cout << "Zajednicki histogram pod mutexom: " << s * 1e9 / n << " ns po unosu, " << (isti(zajednicki) ? "isti sadrzaj" : "RAZLICIT SADRZAJ") << endl;
+	}
+
+	const char* imena[3] = { "spajanje na kraju redom", "spajanje na kraju u parovima", "spajanje tijekom punjenja" };
+	for (int nacin = 0; nacin < 3; nacin++)
+	{
+		ObjektPoDretvi<Histogram1D> histogram(brBinova, 0.0, 1.0);
+		auto pocetak = chrono::steady_clock::now();
+		vector<future<void>> gotovi;
+		for (unsigned d = 0; d < brDretvi; d++)
+			gotovi.push_back(bazen.Posalji([&, d, nacin] {
+				for (uint64_t i = granice[d]; i < granice[d + 1]; i++)
+					histogram.Get().Fill(vrijednost(i));
+				if (nacin == 2)
+					histogram.Predaj();
+			}));
+		for (auto& g : gotovi)
+			g.get();
+		auto punjenje = chrono::steady_clock::now();
+		unique_ptr<Histogram1D> zbroj = histogram.Spoji(nacin == 1 ? &bazen : nullptr);
+		auto kraj = chrono::steady_clock::now();
+		cout << imena[nacin] << ": " << chrono::duration<double>(kraj - pocetak).count() * 1e9 / n << " ns po unosu, zavrsno spajanje "
+			<< chrono::duration<double, milli>(kraj - punjenje).count() << " ms, najvise " << histogram.NajviseKopija() << " kopija, "
+			<< (isti(*zbroj) ? "isti sadrzaj" : "RAZLICIT SADRZAJ") << endl;
+	}
+
+	/* Cijena samog Get: predmemorija u thread_local prema izravnoj referenci */
+	ObjektPoDretvi<Histogram1D> histogram(1, 0.0, 1.0);
+	const size_t brPoziva = 10000000;
+	uintptr_t zbrojAdresa = 0;
+	auto pocetak = chrono::steady_clock::now();
+	for (size_t i = 0; i < brPoziva; i++)
+		zbrojAdresa += (uintptr_t)&histogram.Get();
+	double s = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	cout << "Get: " << s * 1e9 / brPoziva << " ns po pozivu" << (zbrojAdresa == (uintptr_t)&histogram.Get() * brPoziva ? "" : ", RAZLICITE KOPIJE") << endl;
+}
+
+/*
+	Citanja (i rijetka pisanja) zajednickih podataka pod zakljucavanjem L iz brDretvi dretvi. Pisac
+	postavlja sve vrijednosti na isti broj, pa citatelj koji vidi razlicite vrijednosti znaci gresku.
+	Vraca nanosekunde po operaciji.
+*/
+template <class L>
+double MjeriZakljucavanje(unsigned brDretvi, size_t brOperacija, unsigned svakoPisanje, bool& ispravno)
+{
+	L zakljucavanje;
+	double podaci[8] = {};
+	atomic<bool> greska{ false };
+	vector<thread> dretve;
+	auto pocetak = chrono::steady_clock::now();
+	for (unsigned t = 0; t < brDretvi; t++)
+		dretve.emplace_back([&, t] {
+			for (size_t i = 0; i < brOperacija; i++)
+				if (svakoPisanje && (i + t) % svakoPisanje == 0)
+				{
+					lock_guard<L> l(zakljucavanje);
+					for (double& p : podaci)
+						p = (double)i;
+				}
+				else
+				{
+					shared_lock<L> l(zakljucavanje);
+					for (double p : podaci)
+						if (p != podaci[0])
+							greska = true;
+				}
+		});
+	for (auto& d : dretve)
+		d.join();
+	double sekunde = chrono::duration<double>(chrono::steady_clock::now() - pocetak).count();
+	ispravno = !greska;
+	return sekunde * 1e9 / brOperacija;
+}
+
+/* Nacin 16: std::shared_mutex, vrtnja na jednom brojacu i brojaci po utoru, za 1, 2, 4, ... dretvi */
+void BrzinaZakljucavanja()
+{
+	unsigned najviseDretvi, svakoPisanje;
+	size_t brOperacija;
+	cout << "Unesi najveci broj dretvi: " << endl;
+	cin >> najviseDretvi;
+	cout << "Unesi broj operacija po dretvi: " << endl;
+	cin >> brOperacija;
+	cout << "Unesi koja je operacija pisanje (svaka n-ta, 0 - samo citanje): " << endl;
+	cin >> svakoPisanje;
+	najviseDretvi = max(1u, najviseDretvi);
+	cout << "ns po operaciji po dretvi (shared_mutex / SpinRW / RaspodijeljeniRW):" << endl;
+	for (unsigned brDretvi = 1;; brDretvi = min(2 * brDretvi, najviseDretvi))
+	{
+		bool i1, i2, i3;
+		double ns1 = MjeriZakljucavanje<shared_mutex>(brDretvi, brOperacija, svakoPisanje, i1);
+		double ns2 = MjeriZakljucavanje<SpinRW>(brDretvi, brOperacija, svakoPisanje, i2);
+		double ns3 = MjeriZakljucavanje<RaspodijeljeniRW>(brDretvi, brOperacija, svakoPisanje, i3);
+		cout << brDretvi << " dretvi: " << ns1 << " / " << ns2 << " / " << ns3 << (i1 && i2 && i3 ? "" : ", CITANJE ZA VRIJEME PISANJA") << endl;
+		if (brDretvi == najviseDretvi)
+			break;
+	}
+}
+
+int main()
+{
+	cout << std::fixed;
+	cout << std::setprecision(5);
+	srand(time(NULL));
+	mt19937_64 gen(time(NULL));
+	int nacin;
+	char odg1;
+	
+	do
+	{
+	cout << "Odaberi nacin rada (1 - puna simulacija, 2 - binomna provjera, 3 - usporedba punog i binomnog, 4 - testiranje generatora, "
+		"5 - ugadjanje kontrolnih varijabli, 6 - prostorna jednolikost tocaka, 7 - ucitavanje rezultata, 8 - obrtanje bajtova, 9 - brzina histograma, 10 - brzina utora, 11 - ponovljiva simulacija, 12 - mali vektori, 13 - raspored dretvi, 14 - cjevovod s nastavcima, 15 - objekt po dretvi, 16 - zakljucavanje citatelj/pisac): " << endl;
+	cin >> nacin;
+	if (nacin == 4)
+	{
+		int potencija;
+		cout << "Unesi potenciju (10^p brojeva po generatoru): " << endl;
+		cin >> potencija;
+		TestirajGeneratore(potencija, (uint32_t)time(NULL));
+	}
+	else if (nacin == 5)
+		UgadjanjeKontrolnihVarijabli();
+	else if (nacin == 6)
+		ProstornaJednolikost();
+	else if (nacin == 7)
+		UcitajRezultate();
+	else if (nacin == 8)
+		ObrtanjeBajtova(gen);
+	else if (nacin == 9)
+		BrzinaHistograma(gen);
+	else if (nacin == 10)
+		BrzinaUtora();
+	else if (nacin == 11)
+		PonovljivaSimulacija();
+	else if (nacin == 12)
+		BrzinaMalihVektora(gen);
+	else if (nacin == 13)
+		BrzinaRasporeda();
+	else if (nacin == 14)
+		BrzinaCjevovoda();
+	else if (nacin == 15)
+		BrzinaObjektaPoDretvi();
+	else if (nacin == 16)
+		BrzinaZakljucavanja();
+	else
+		PiEksperiment(nacin, gen);
+
 	cout << "Zelite li ponoviti sve eksperimente s drugom potencijom?(y/n)" <<endl ;
 	cin >> odg1;
-	}while(odg1 != 'y');	
+	}while(odg1 == 'y');	
 	system("PAUSE");
 	return 0;
 }
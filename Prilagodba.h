@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+/*
+	Prilagodba zakona konvergencije stDev = a * N^-b (ocekivano a = sqrt(\pi(4-\pi)), b = 1/2).
+	Podaci se ne kopiraju: prilagodba radi nad pogledima na stupce koje je napravio sampler.
+*/
+
+/* Pogled bez kopiranja na n procjena y dobivenih s istim brojem tocaka N */
+struct StupacProcjena
+{
+	double N;
+	const double* y;
+	size_t n;
+};
+
+struct RezultatPrilagodbe
+{
+	double a = 0.0, aGr = 0.0, b = 0.0, bGr = 0.0;
+	double chi2 = 0.0;
+	int ndf = 0;
+	bool uspjeh = false;
+};
+
+/*
+	Suma (y_i - mu)^2 s cetiri neovisna zbroja, tako da prevoditelj petlju moze vektorizirati
+	(SSE2/AVX) bez mijenjanja redoslijeda zbrajanja izmedju pokretanja.
+*/
+inline double SumaKvadrataOdstupanja(const double* y, size_t n, double mu)
+{
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		double d0 = y[i] - mu, d1 = y[i + 1] - mu, d2 = y[i + 2] - mu, d3 = y[i + 3] - mu;
+		s0 += d0 * d0;
+		s1 += d1 * d1;
+		s2 += d2 * d2;
+		s3 += d3 * d3;
+	}
+	for (; i < n; i++)
+		s0 += (y[i] - mu) * (y[i] - mu);
+	return (s0 + s1) + (s2 + s3);
+}
+
+/*
+	Binirana prilagodba: stDev_j naspram N_j, najmanji kvadrati u log-log prostoru
+	ln stDev = ln a - b ln N. Relativna pogreska stDev iz brPon ponavljanja je 1/sqrt(2(brPon-1)),
+	pa se iz nje dobiva chi^2. Tocke sa stDev <= 0 se preskacu.
+*/
+inline RezultatPrilagodbe PrilagodiStDev(const double* N, const double* stDev, size_t n, int brPon)
+{
+	RezultatPrilagodbe r;
+	double S = 0, Sx = 0, Sy = 0, Sxx = 0, Sxy = 0;
+	for (size_t j = 0; j < n; j++)
+	{
+		if (stDev[j] <= 0.0)
+			continue;
+		double x = log(N[j]), y = log(stDev[j]);
+		S += 1;
+		Sx += x;
+		Sy += y;
+		Sxx += x * x;
+		Sxy += x * y;
+	}
+	double det = S * Sxx - Sx * Sx;
+	if (S < 2 || det <= 0.0 || brPon < 2)
+		return r;
+
+	double nagib = (S * Sxy - Sx * Sy) / det, odsjecak = (Sy - nagib * Sx) / S;
+	double sigma2 = 1.0 / (2.0 * (brPon - 1));
+	r.b = -nagib;
+	r.bGr = sqrt(sigma2 * S / det);
+	r.a = exp(odsjecak);
+	r.aGr = r.a * sqrt(sigma2 * Sxx / det);
+	for (size_t j = 0; j < n; j++)
+	{
+		if (stDev[j] <= 0.0)
+			continue;
+		double d = log(stDev[j]) - odsjecak - nagib * log(N[j]);
+		r.chi2 += d * d / sigma2;
+	}
+	r.ndf = (int)S - 2;
+	r.uspjeh = true;
+	return r;
+}
+
+/*
+	Nebinirana prilagodba metodom najvece vjerodostojnosti nad svim pojedinim procjenama:
+	y ~ Gauss(mu, a N^-b). Jer je N isti unutar stupca, jedan prolaz po podacima
+	(paralelno, po komadima stalne velicine i sa zbrajanjem uvijek istim redom) daje
+	R_j = suma (y - mu)^2, a Newtonove iteracije po (ln a, b) rade samo nad R_j.
+*/
+inline RezultatPrilagodbe PrilagodiML(const std::vector<StupacProcjena>& stupci, double mu, unsigned brDretvi = 0)
+{
+	const size_t KOMAD = 1 << 16;
+	struct Komad { size_t stupac, od, n; };
+	std::vector<Komad> komadi;
+	for (size_t j = 0; j < stupci.size(); j++)
+		for (size_t od = 0; od < stupci[j].n; od += KOMAD)
+			komadi.push_back({ j, od, std::min(KOMAD, stupci[j].n - od) });
+
+	std::vector<double> djelomicno(komadi.size());
+	std::atomic<size_t> sljedeci(0);
+	auto radnik = [&]() {
+		for (size_t i = sljedeci++; i < komadi.size(); i = sljedeci++)
+		{
+			const Komad& k = komadi[i];
+			djelomicno[i] = SumaKvadrataOdstupanja(stupci[k.stupac].y + k.od, k.n, mu);
+		}
+	};
+	if (brDretvi == 0)
+		brDretvi = std::max(1u, std::thread::hardware_concurrency());
+	brDretvi = (unsigned)std::min<size_t>(brDretvi, komadi.size());
+	if (brDretvi <= 1)
+		radnik();
+	else
+	{
+		std::vector<std::thread> dretve;
+		for (unsigned t = 0; t < brDretvi; t++)
+			dretve.emplace_back(radnik);
+		for (auto& d : dretve)
+			d.join();
+	}
+
+	std::vector<double> R(stupci.size(), 0.0), L(stupci.size()), n(stupci.size());
+	for (size_t i = 0; i < komadi.size(); i++)
+		R[komadi[i].stupac] += djelomicno[i];
+	double brUk = 0, RN = 0;
+	for (size_t j = 0; j < stupci.size(); j++)
+	{
+		L[j] = log(stupci[j].N);
+		n[j] = (double)stupci[j].n;
+		brUk += n[j];
+		RN += R[j] * stupci[j].N;
+	}
+
+	RezultatPrilagodbe r;
+	if (stupci.size() < 2 || brUk < 3 || RN <= 0.0)
+		return r;
+
+	/* -lnL = suma_j [ n_j (t - b L_j) + R_j exp(2 (b L_j - t)) / 2 ], t = ln a; konveksna funkcija */
+	double t = 0.5 * log(RN / brUk), b = 0.5;
+	double Htt = 0, Htb = 0, Hbb = 0;
+	for (int iter = 0; iter < 100; iter++)
+	{
+		double gt = 0, gb = 0;
+		Htt = Htb = Hbb = 0;
+		for (size_t j = 0; j < R.size(); j++)
+		{
+			double e = R[j] * exp(2.0 * (b * L[j] - t));
+			gt += n[j] - e;
+			gb += -n[j] * L[j] + L[j] * e;
+			Htt += 2.0 * e;
+			Htb += -2.0 * L[j] * e;
+			Hbb += 2.0 * L[j] * L[j] * e;
+		}
+		double det = Htt * Hbb - Htb * Htb;
+		if (det <= 0.0)
+			return r;
+		double dt = (Hbb * gt - Htb * gb) / det, db = (Htt * gb - Htb * gt) / det;
+		t -= dt;
+		b -= db;
+		if (fabs(dt) < 1e-12 && fabs(db) < 1e-12)
+		{
+			r.uspjeh = true;
+			break;
+		}
+	}
+	double det = Htt * Hbb - Htb * Htb;
+	r.a = exp(t);
+	r.aGr = r.a * sqrt(Hbb / det);
+	r.b = b;
+	r.bGr = sqrt(Htt / det);
+	r.ndf = (int)brUk - 2;
+	return r;
+}
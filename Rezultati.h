@@ -0,0 +1,736 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BazenDretvi.h"
+#include "Sazimanje.h"
+#include "ZamjenaBajtova.h"
+
+/*
+	Datoteka rezultata: stupci (double ili int64) spremljeni u kosarama, kao grane u stablu.
+	Izgled datoteke:
+		"PI2R", verzija u32, oznaka poretka bajtova u32, broj stupaca u32,
+		za svaki stupac: duljina imena u16, ime, tip u8
+		zapisi: 'R' rjecnik  { stupac u32, duljina u32, bajtovi }
+		        'K' kosara   { stupac u32, prvi red u64, broj redova u32, algoritam u8, sirovo u32, sazeto u32, bajtovi }
+		        'E' kraj     { broj redova u64 }
+	Brojevi se zapisuju u poretku bajtova racunala koje pise; oznaka 0x01020304 govori kojem,
+	pa citac datoteku s drugim poretkom obrce pri citanju.
+*/
+
+const uint32_t REZ_VERZIJA = 1;
+const uint32_t REZ_OZNAKA_PORETKA = 0x01020304;
+
+enum class TipStupca : uint8_t
+{
+	Double = 0,
+	Int64 = 1
+};
+
+/*
+	Neprekinuti niz vrijednosti jednog stupca: redovi [prviRed, prviRed + n) iz jedne raspakirane kosare.
+	Niz vrijedi do sljedeceg citanja istog stupca.
+*/
+template <class T>
+struct RasponStupca
+{
+	const T* podaci = nullptr;
+	uint64_t prviRed = 0;
+	size_t n = 0;
+
+	const T* begin() const { return podaci; }
+	const T* end() const { return podaci + n; }
+	const T& operator[](size_t i) const { return podaci[i]; }
+};
+
+/*
+	Pisanje datoteke rezultata. Bez bazena dretvi puna kosara se sazima i zapisuje odmah, u dretvi
+	koja zove Popuni(). S bazenom se puna kosara predaje bazenu na sazimanje, a posebna dretva
+	zapisuje gotove kosare u datoteku redom kojim su predane; proizvodjac tada placa samo kopiranje
+	u kosaru. Najvise maxUObradi kosara je istovremeno u obradi, pa je memorija ogranicena:
+	kad ih je toliko, Popuni() ceka da se jedna zapise (vrijeme cekanja se zbraja u SekundeCekanja()).
+*/
+class PisacRezultata
+{
+public:
+	PisacRezultata(const std::string& ime, PostavkeSazimanja postavke, BazenDretvi* bazen = nullptr,
+		size_t maxUObradi = 16, size_t velicinaKosare = 32000)
+		: dat(ime, std::ios::binary), postavke(postavke), bazen(bazen), maxUObradi(std::max<size_t>(1, maxUObradi)),
+		velicinaKosare(velicinaKosare)
+	{
+		if (!dat)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+		if (bazen)
+			pisac = std::thread([this] { Zapisivac(); });
+	}
+
+	~PisacRezultata()
+	{
+		try
+		{
+			Zatvori();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	/* Stupac cita vrijednost s adrese pri svakom Popuni() */
+	void Stupac(const std::string& ime, const double* adresa) { DodajStupac(ime, TipStupca::Double, adresa); }
+	void Stupac(const std::string& ime, const int64_t* adresa) { DodajStupac(ime, TipStupca::Int64, adresa); }
+
+	/* Trenutne vrijednosti svih stupaca idu u njihove kosare; puna kosara se sazima i zapisuje */
+	void Popuni()
+	{
+		if (!zaglavljeZapisano)
+			ZapisiZaglavlje();
+		for (size_t s = 0; s < stupci.size(); s++)
+		{
+			OpisStupca& st = stupci[s];
+			const uint8_t* v = (const uint8_t*)st.adresa;
+			st.kosara.insert(st.kosara.end(), v, v + 8);
+			if (st.kosara.size() >= velicinaKosare)
+				IsprazniKosaru(s);
+		}
+		brRedova++;
+	}
+
+	/* Baca i gresku sazimanja ili pisanja iz pozadinske obrade; datoteka tada ostaje bez zavrsetka */
+	void Zatvori()
+	{
+		if (zatvoreno)
+			return;
+		zatvoreno = true;
+		std::exception_ptr e;
+		try
+		{
+			if (!zaglavljeZapisano)
+				ZapisiZaglavlje();
+			for (size_t s = 0; s < stupci.size(); s++)
+			{
+				if (!stupci[s].kosara.empty())
+					IsprazniKosaru(s);
+				if (stupci[s].cekaRjecnik)
+					TrenirajIPredajCekajuce(s);
+			}
+		}
+		catch (...)
+		{
+			e = std::current_exception();
+		}
+		/* Dretva za pisanje mora zavrsiti i kad je bilo greske, jer kosare u redu pokazuju na ovaj objekt */
+		if (pisac.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> l(mtx);
+				kraj = true;
+			}
+			cv.notify_all();
+			pisac.join();
+		}
+		if (!e)
+			e = greska;
+		if (e)
+		{
+			dat.close();
+			std::rethrow_exception(e);
+		}
+		Pisi<uint8_t>('E');
+		Pisi<uint64_t>(brRedova);
+		dat.close();
+		if (dat.fail())
+			throw std::runtime_error("Greska pri pisanju datoteke rezultata");
+	}
+
+	uint64_t BrojRedova() const { return brRedova; }
+	uint64_t BajtovaSirovo() const { return bajtovaSirovo; }
+	uint64_t BajtovaZapisano() const { return bajtovaZapisano; }
+	double SekundeCekanja() const { return sekundeCekanja; }
+
+private:
+	struct OpisStupca
+	{
+		std::string ime;
+		TipStupca tip;
+		const void* adresa;
+		std::vector<uint8_t> kosara;
+		std::shared_ptr<const RjecnikSazimanja> rjecnik;
+		uint64_t prviRed = 0;
+		bool cekaRjecnik = false;
+		std::vector<std::pair<uint64_t, std::vector<uint8_t>>> cekajuce;
+	};
+
+	/* Zapis koji ceka na red za pisanje: rjecnik ('R') ili kosara ('K') koja se mozda jos sazima */
+	struct Posao
+	{
+		uint8_t vrsta;
+		uint32_t stupac;
+		uint64_t prviRed;
+		std::vector<uint8_t> sirovo, sazeto;
+		std::shared_ptr<const RjecnikSazimanja> rjecnik;
+		Algoritam algoritam = Algoritam::Bez;
+		std::future<void> gotovo;
+	};
+
+	/* Kosare koje se skupe prije treniranja rjecnika */
+	static const size_t KOSARA_ZA_RJECNIK = 4;
+
+	void DodajStupac(const std::string& ime, TipStupca tip, const void* adresa)
+	{
+		if (zaglavljeZapisano)
+			throw std::runtime_error("Stupci se dodaju prije prvog Popuni()");
+		OpisStupca s;
+		s.ime = ime;
+		s.tip = tip;
+		s.adresa = adresa;
+		s.cekaRjecnik = postavke.rjecnik && postavke.algoritam != Algoritam::Bez && ZSTDDostupan();
+		stupci.push_back(s);
+	}
+
+	template <class T>
+	void Pisi(T v)
+	{
+		dat.write((const char*)&v, sizeof(T));
+		bajtovaZapisano += sizeof(T);
+	}
+
+	void PisiBajtove(const uint8_t* p, size_t n)
+	{
+		dat.write((const char*)p, n);
+		bajtovaZapisano += n;
+	}
+
+	void ZapisiZaglavlje()
+	{
+		PisiBajtove((const uint8_t*)"PI2R", 4);
+		Pisi<uint32_t>(REZ_VERZIJA);
+		Pisi<uint32_t>(REZ_OZNAKA_PORETKA);
+		Pisi<uint32_t>((uint32_t)stupci.size());
+		for (const auto& s : stupci)
+		{
+			Pisi<uint16_t>((uint16_t)s.ime.size());
+			PisiBajtove((const uint8_t*)s.ime.data(), s.ime.size());
+			Pisi<uint8_t>((uint8_t)s.tip);
+		}
+		zaglavljeZapisano = true;
+	}
+
+	void IsprazniKosaru(size_t s)
+	{
+		OpisStupca& st = stupci[s];
+		uint64_t prvi = st.prviRed;
+		st.prviRed += st.kosara.size() / 8;
+		std::vector<uint8_t> kosara;
+		kosara.reserve(velicinaKosare + 8);
+		kosara.swap(st.kosara);
+		if (st.cekaRjecnik)
+		{
+			st.cekajuce.push_back({ prvi, std::move(kosara) });
+			if (st.cekajuce.size() >= KOSARA_ZA_RJECNIK)
+				TrenirajIPredajCekajuce(s);
+			return;
+		}
+		PredajKosaru(s, prvi, std::move(kosara));
+	}
+
+	/*
+		Rjecnik iz prvih kosara stupca (svaka kosara dana kao vise uzoraka), pa predaja cekajucih kosara.
+		Treniranje se radi jednom po stupcu, u dretvi proizvodjaca.
+	*/
+	void TrenirajIPredajCekajuce(size_t s)
+	{
+		OpisStupca& st = stupci[s];
+		std::vector<std::vector<uint8_t>> uzorci;
+		size_t ukupno = 0;
+		for (const auto& k : st.cekajuce)
+			for (size_t od = 0; od < k.second.size(); od += 1024)
+			{
+				uzorci.emplace_back(k.second.begin() + od, k.second.begin() + std::min(k.second.size(), od + 1024));
+				ukupno += uzorci.back().size();
+			}
+		/* ZSTD_CDict se priprema jednom po stupcu, a ne pri svakom sazimanju kosare */
+		auto rjecnik = std::make_shared<const RjecnikSazimanja>(TrenirajRjecnik(uzorci, std::min<size_t>(16 * 1024, ukupno / 8)), postavke.razina);
+		if (!rjecnik->Bajtovi().empty())
+		{
+			st.rjecnik = rjecnik;
+			std::unique_ptr<Posao> p(new Posao);
+			p->vrsta = 'R';
+			p->stupac = (uint32_t)s;
+			p->rjecnik = rjecnik;
+			Predaj(std::move(p));
+		}
+		st.cekaRjecnik = false;
+		for (auto& k : st.cekajuce)
+			PredajKosaru(s, k.first, std::move(k.second));
+		st.cekajuce.clear();
+	}
+
+	void PredajKosaru(size_t s, uint64_t prviRed, std::vector<uint8_t> sirovo)
+	{
+		std::unique_ptr<Posao> p(new Posao);
+		p->vrsta = 'K';
+		p->stupac = (uint32_t)s;
+		p->prviRed = prviRed;
+		p->sirovo = std::move(sirovo);
+		p->rjecnik = stupci[s].rjecnik;
+		Predaj(std::move(p));
+	}
+
+	void Sazmi(Posao& p) const
+	{
+		if (postavke.algoritam != Algoritam::Bez && ::Sazmi(postavke, p.rjecnik.get(), p.sirovo.data(), p.sirovo.size(), p.sazeto))
+			p.algoritam = postavke.algoritam;
+	}
+
+	/* Sinkrono: sazmi i zapisi odmah. Asinkrono: cekaj mjesto u redu, pa sazimanje predaj bazenu */
+	void Predaj(std::unique_ptr<Posao> p)
+	{
+		if (!bazen)
+		{
+			if (p->vrsta == 'K')
+				Sazmi(*p);
+			Zapisi(*p);
+			return;
+		}
+		std::unique_lock<std::mutex> l(mtx);
+		if (red.size() >= maxUObradi)
+		{
+			auto pocetak = std::chrono::steady_clock::now();
+			cv.wait(l, [this] { return red.size() < maxUObradi; });
+			sekundeCekanja += std::chrono::duration<double>(std::chrono::steady_clock::now() - pocetak).count();
+		}
+		if (greska)
+			std::rethrow_exception(greska);
+		if (p->vrsta == 'K')
+		{
+			Posao* sirov = p.get();
+			p->gotovo = bazen->Posalji([this, sirov] { Sazmi(*sirov); });
+		}
+		red.push_back(std::move(p));
+		cv.notify_all();
+	}
+
+	void Zapisi(const Posao& p)
+	{
+		if (p.vrsta == 'R')
+		{
+			Pisi<uint8_t>('R');
+			Pisi<uint32_t>(p.stupac);
+			Pisi<uint32_t>((uint32_t)p.rjecnik->Bajtovi().size());
+			PisiBajtove(p.rjecnik->Bajtovi().data(), p.rjecnik->Bajtovi().size());
+			return;
+		}
+		const std::vector<uint8_t>& podaci = p.algoritam == Algoritam::Bez ? p.sirovo : p.sazeto;
+		Pisi<uint8_t>('K');
+		Pisi<uint32_t>(p.stupac);
+		Pisi<uint64_t>(p.prviRed);
+		Pisi<uint32_t>((uint32_t)(p.sirovo.size() / 8));
+		Pisi<uint8_t>((uint8_t)p.algoritam);
+		Pisi<uint32_t>((uint32_t)p.sirovo.size());
+		Pisi<uint32_t>((uint32_t)podaci.size());
+		PisiBajtove(podaci.data(), podaci.size());
+		bajtovaSirovo += p.sirovo.size();
+	}
+
+	/*
+		Dretva za pisanje: zapisi idu u datoteku tocno redom predaje. Greska sazimanja ili pisanja se
+		pamti i javlja iz Popuni/Zatvori u dretvi pozivatelja; nakon nje se kosare vise ne zapisuju,
+		ali se i dalje ceka njihovo sazimanje i prazni red.
+	*/
+	void Zapisivac()
+	{
+		for (;;)
+		{
+			Posao* p;
+			bool pisati;
+			{
+				std::unique_lock<std::mutex> l(mtx);
+				cv.wait(l, [this] { return kraj || !red.empty(); });
+				if (red.empty())
+					return;
+				p = red.front().get();
+				pisati = !greska;
+			}
+			try
+			{
+				if (p->gotovo.valid())
+					p->gotovo.get();
+				if (pisati)
+					Zapisi(*p);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> l(mtx);
+				if (!greska)
+					greska = std::current_exception();
+			}
+			{
+				std::lock_guard<std::mutex> l(mtx);
+				red.pop_front();
+			}
+			cv.notify_all();
+		}
+	}
+
+	std::ofstream dat;
+	PostavkeSazimanja postavke;
+	BazenDretvi* bazen;
+	size_t maxUObradi, velicinaKosare;
+	std::vector<OpisStupca> stupci;
+	uint64_t brRedova = 0, bajtovaSirovo = 0, bajtovaZapisano = 0;
+	double sekundeCekanja = 0.0;
+	bool zaglavljeZapisano = false, zatvoreno = false;
+
+	std::thread pisac;
+	std::deque<std::unique_ptr<Posao>> red;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool kraj = false;
+	std::exception_ptr greska;
+};
+
+/*
+	Citanje datoteke rezultata. Pri otvaranju se procita zaglavlje i popis kosara (bez podataka),
+	a vrijednost se dohvaca red po red: kosara koja sadrzi red ucita se i raspakira pri prvom pristupu.
+	Uz zadani raspored citanja kosare se citaju unaprijed u pozadinskoj dretvi.
+*/
+class CitacRezultata
+{
+public:
+	explicit CitacRezultata(const std::string& ime) : ime(ime), dat(ime, std::ios::binary)
+	{
+		if (!dat)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+		/* Velicine zapisa provjeravaju se prema velicini datoteke, pa pokvarena datoteka ne cita izvan kosare */
+		dat.seekg(0, std::ios::end);
+		const uint64_t velicina = (uint64_t)dat.tellg();
+		dat.seekg(0);
+		char magija[4];
+		dat.read(magija, 4);
+		if (!dat || std::memcmp(magija, "PI2R", 4) != 0)
+			throw std::runtime_error(ime + " nije datoteka rezultata");
+		uint32_t verzija = Citaj<uint32_t>(), oznaka = Citaj<uint32_t>();
+		if (oznaka == ObrniBajtove(REZ_OZNAKA_PORETKA))
+		{
+			/* Datoteka s drugog racunala: brojevi u zaglavlju i podaci kosara se obrcu pri citanju */
+			obrni = true;
+			verzija = ObrniBajtove(verzija);
+		}
+		else if (oznaka != REZ_OZNAKA_PORETKA)
+			throw std::runtime_error("Neispravna oznaka poretka bajtova");
+		if (verzija != REZ_VERZIJA)
+			throw std::runtime_error("Nepoznata verzija datoteke rezultata");
+		uint32_t brStupaca = Citaj<uint32_t>();
+		stupci.resize(brStupaca);
+		for (auto& s : stupci)
+		{
+			uint16_t duljina = Citaj<uint16_t>();
+			s.ime.resize(duljina);
+			dat.read(&s.ime[0], duljina);
+			s.tip = (TipStupca)Citaj<uint8_t>();
+		}
+
+		for (;;)
+		{
+			uint8_t oznakaZapisa = Citaj<uint8_t>();
+			if (oznakaZapisa == 'E')
+			{
+				brRedova = Citaj<uint64_t>();
+				break;
+			}
+			uint32_t s = Citaj<uint32_t>();
+			if (s >= stupci.size())
+				throw std::runtime_error("Neispravan zapis u datoteci rezultata");
+			if (oznakaZapisa == 'R')
+			{
+				uint32_t duljina = Citaj<uint32_t>();
+				if (duljina > velicina - (uint64_t)dat.tellg())
+					throw std::runtime_error("Datoteka rezultata je skracena");
+				std::vector<uint8_t> bajtovi(duljina);
+				dat.read((char*)bajtovi.data(), bajtovi.size());
+				stupci[s].rjecnik = std::make_shared<const RjecnikSazimanja>(std::move(bajtovi));
+			}
+			else if (oznakaZapisa == 'K')
+			{
+				Kosara k;
+				k.prviRed = Citaj<uint64_t>();
+				k.brRedova = Citaj<uint32_t>();
+				k.algoritam = (Algoritam)Citaj<uint8_t>();
+				k.sirovo = Citaj<uint32_t>();
+				k.sazeto = Citaj<uint32_t>();
+				k.pomak = (uint64_t)dat.tellg();
+				/* Kosare stupca moraju ici redom i bez preklapanja, jer se red trazi binarno */
+				const std::vector<Kosara>& kosare = stupci[s].kosare;
+				if (k.sirovo != (uint64_t)k.brRedova * 8
+					|| (!kosare.empty() && k.prviRed < kosare.back().prviRed + kosare.back().brRedova))
+					throw std::runtime_error("Neispravna kosara u datoteci rezultata");
+				if (k.sazeto > velicina - k.pomak)
+					throw std::runtime_error("Datoteka rezultata je skracena");
+				dat.seekg(k.sazeto, std::ios::cur);
+				stupci[s].kosare.push_back(k);
+			}
+			else
+				throw std::runtime_error("Neispravan zapis u datoteci rezultata");
+		}
+	}
+
+	uint64_t BrojRedova() const { return brRedova; }
+	size_t BrojStupaca() const { return stupci.size(); }
+	const std::string& ImeStupca(size_t s) const { return stupci[s].ime; }
+	TipStupca Tip(size_t s) const { return stupci[s].tip; }
+
+	int IndeksStupca(const std::string& ime) const
+	{
+		for (size_t s = 0; s < stupci.size(); s++)
+			if (stupci[s].ime == ime)
+				return (int)s;
+		return -1;
+	}
+
+	bool DrugiPoredakBajtova() const { return obrni; }
+
+	double Double(size_t s, uint64_t red) { return Vrijednost<double>(s, red); }
+	int64_t Int64(size_t s, uint64_t red) { return Vrijednost<int64_t>(s, red); }
+
+	/*
+		Citanje po kosarama: sve vrijednosti stupca od reda red do kraja njegove kosare, bez kopiranja.
+		Petlja nad rasponima je jednaka petlji po redovima, ali se trazenje kosare radi jednom po kosari.
+	*/
+	RasponStupca<double> DoubleRaspon(size_t s, uint64_t red) { return Raspon<double>(s, red, TipStupca::Double); }
+	RasponStupca<int64_t> Int64Raspon(size_t s, uint64_t red) { return Raspon<int64_t>(s, red, TipStupca::Int64); }
+
+	/*
+		Raspored citanja poznat unaprijed: citat ce se redom samo zadani stupci u redovima [od, doo).
+		Raspon se dijeli na skupine redova po kosarama prvog stupca. Dok se obradjuje jedna skupina,
+		posebna dretva cita (vlastitim otvaranjem datoteke, redom pomaka) i raspakira sve kosare
+		sljedece, pa se citanje s diska i raspakiravanje preklapaju s obradom. Pristup izvan rasporeda
+		radi kao i prije, samo bez citanja unaprijed.
+	*/
+	void ZakaziCitanje(const std::vector<size_t>& stupciRasporeda, uint64_t od, uint64_t doo)
+	{
+		if (buduca.valid())
+			buduca.wait();
+		raspored = stupciRasporeda;
+		granice.clear();
+		ucitana = Skupina();
+		buduca = std::future<Skupina>();
+		if (raspored.empty() || od >= doo)
+			return;
+		granice.push_back(od);
+		for (const Kosara& k : stupci[raspored[0]].kosare)
+			if (k.prviRed > od && k.prviRed < doo)
+				granice.push_back(k.prviRed);
+		granice.push_back(doo);
+		PokreniSkupinu(0);
+	}
+
+	/* Koliko je kosara dohvaceno unaprijed i koliko se cekalo na skupine koje jos nisu bile spremne */
+	size_t KosaraUnaprijed() const { return brUnaprijed; }
+	double SekundeCekanja() const { return sekundeCekanja; }
+
+private:
+	struct Kosara
+	{
+		uint64_t prviRed, pomak;
+		uint32_t brRedova, sirovo, sazeto;
+		Algoritam algoritam;
+	};
+
+	struct Stupac
+	{
+		std::string ime;
+		TipStupca tip;
+		std::shared_ptr<const RjecnikSazimanja> rjecnik;
+		std::vector<Kosara> kosare;
+		long trenutna = -1;
+		std::vector<uint8_t> podaci;
+	};
+
+	/* Raspakirane kosare jedne skupine redova iz rasporeda */
+	struct Skupina
+	{
+		long indeks = -1;
+		std::vector<size_t> stupac;
+		std::vector<long> kosara;
+		std::vector<std::vector<uint8_t>> podaci;
+	};
+
+	template <class T>
+	T Citaj()
+	{
+		T v;
+		dat.read((char*)&v, sizeof(T));
+		if (!dat)
+			throw std::runtime_error("Datoteka rezultata je skracena");
+		return obrni ? ObrniBajtove(v) : v;
+	}
+
+	/* Cita i raspakira kosaru ko iz d u podaci */
+	static void ProcitajKosaru(std::ifstream& d, const Kosara& ko, const RjecnikSazimanja* rjecnik, bool obrni,
+		std::vector<uint8_t>& podaci)
+	{
+		std::vector<uint8_t> sazeto(ko.sazeto);
+		d.clear();
+		d.seekg(ko.pomak);
+		d.read((char*)sazeto.data(), sazeto.size());
+		if (!d)
+			throw std::runtime_error("Datoteka rezultata je skracena");
+		podaci.resize(ko.sirovo);
+		Raspakiraj(ko.algoritam, rjecnik, sazeto.data(), sazeto.size(), podaci.data(), podaci.size());
+		if (obrni)
+			ObrniBajtoveNiza(podaci.data(), podaci.size() / 8, 8);
+	}
+
+	/* Kosara k stupca st postaje trenutna: iz ucitane skupine rasporeda ako je ondje, inace s diska */
+	void UcitajKosaru(size_t s, long k, uint64_t red)
+	{
+		Stupac& st = stupci[s];
+		if (IzRasporeda(s, k, red))
+		{
+			st.trenutna = k;
+			brUnaprijed++;
+			return;
+		}
+		ProcitajKosaru(dat, st.kosare[k], st.rjecnik.get(), obrni, st.podaci);
+		st.trenutna = k;
+	}
+
+	/* Zadaje dretvi citanje skupine c (ako postoji) */
+	void PokreniSkupinu(long c)
+	{
+		if (c + 1 >= (long)granice.size())
+			return;
+		buduca = std::async(std::launch::async, [this, c] { return CitajSkupinu(c); });
+	}
+
+	/* Sve kosare stupaca rasporeda koje se preklapaju s redovima skupine c, citane redom pomaka u datoteci */
+	Skupina CitajSkupinu(long c)
+	{
+		if (!datUnaprijed.is_open())
+			datUnaprijed.open(ime, std::ios::binary);
+		Skupina sk;
+		sk.indeks = c;
+		std::vector<std::pair<uint64_t, size_t>> poredak;
+		for (size_t s : raspored)
+		{
+			const std::vector<Kosara>& kosare = stupci[s].kosare;
+			for (long k = 0; k < (long)kosare.size(); k++)
+				if (kosare[k].prviRed < granice[c + 1] && kosare[k].prviRed + kosare[k].brRedova > granice[c])
+				{
+					poredak.push_back({ kosare[k].pomak, sk.stupac.size() });
+					sk.stupac.push_back(s);
+					sk.kosara.push_back(k);
+				}
+		}
+		std::sort(poredak.begin(), poredak.end());
+		sk.podaci.resize(sk.stupac.size());
+		for (const auto& p : poredak)
+		{
+			const Stupac& st = stupci[sk.stupac[p.second]];
+			ProcitajKosaru(datUnaprijed, st.kosare[sk.kosara[p.second]], st.rjecnik.get(), obrni, sk.podaci[p.second]);
+		}
+		return sk;
+	}
+
+	/* Preuzima kosaru k stupca s iz rasporeda; skupina koja sadrzi red se po potrebi dovrsava, a sljedeca pokrece */
+	bool IzRasporeda(size_t s, long k, uint64_t red)
+	{
+		if (granice.empty() || red < granice.front() || red >= granice.back() ||
+			std::find(raspored.begin(), raspored.end(), s) == raspored.end())
+			return false;
+		long c = (long)(std::upper_bound(granice.begin(), granice.end(), red) - granice.begin()) - 1;
+		if (ucitana.indeks != c)
+		{
+			if (buduca.valid())
+			{
+				auto pocetak = std::chrono::steady_clock::now();
+				ucitana = buduca.get();
+				sekundeCekanja += std::chrono::duration<double>(std::chrono::steady_clock::now() - pocetak).count();
+			}
+			if (ucitana.indeks != c)
+				ucitana = CitajSkupinu(c);
+			PokreniSkupinu(c + 1);
+		}
+		for (size_t i = 0; i < ucitana.stupac.size(); i++)
+			if (ucitana.stupac[i] == s && ucitana.kosara[i] == k && !ucitana.podaci[i].empty())
+			{
+				stupci[s].podaci.swap(ucitana.podaci[i]);
+				ucitana.podaci[i].clear();
+				return true;
+			}
+		return false;
+	}
+
+	/* Ucitava kosaru stupca s u kojoj je red, ako vec nije ucitana */
+	Stupac& KosaraZaRed(size_t s, uint64_t red)
+	{
+		Stupac& st = stupci[s];
+		if (st.trenutna < 0 || red < st.kosare[st.trenutna].prviRed || red >= st.kosare[st.trenutna].prviRed + st.kosare[st.trenutna].brRedova)
+		{
+			/* Kosare su poredane po prvom redu: binarno trazenje */
+			long lo = 0, hi = (long)st.kosare.size() - 1;
+			while (lo < hi)
+			{
+				long mid = (lo + hi + 1) / 2;
+				if (st.kosare[mid].prviRed <= red)
+					lo = mid;
+				else
+					hi = mid - 1;
+			}
+			if (st.kosare.empty() || red < st.kosare[lo].prviRed || red >= st.kosare[lo].prviRed + st.kosare[lo].brRedova)
+				throw std::runtime_error("Red izvan datoteke rezultata");
+			UcitajKosaru(s, lo, red);
+		}
+		return st;
+	}
+
+	template <class T>
+	T Vrijednost(size_t s, uint64_t red)
+	{
+		Stupac& st = KosaraZaRed(s, red);
+		T v;
+		std::memcpy(&v, st.podaci.data() + (red - st.kosare[st.trenutna].prviRed) * 8, 8);
+		return v;
+	}
+
+	template <class T>
+	RasponStupca<T> Raspon(size_t s, uint64_t red, TipStupca tip)
+	{
+		if (stupci[s].tip != tip)
+			throw std::runtime_error("Stupac " + stupci[s].ime + " je drugog tipa");
+		Stupac& st = KosaraZaRed(s, red);
+		const Kosara& ko = st.kosare[st.trenutna];
+		RasponStupca<T> r;
+		r.podaci = (const T*)st.podaci.data() + (red - ko.prviRed);
+		r.prviRed = red;
+		r.n = (size_t)(ko.prviRed + ko.brRedova - red);
+		return r;
+	}
+
+	std::string ime;
+	std::ifstream dat, datUnaprijed;
+	std::vector<Stupac> stupci;
+	uint64_t brRedova = 0;
+	bool obrni = false;
+
+	std::vector<size_t> raspored;
+	std::vector<uint64_t> granice;
+	Skupina ucitana;
+	size_t brUnaprijed = 0;
+	double sekundeCekanja = 0.0;
+	std::future<Skupina> buduca;
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef PI2TEST_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+/*
+	Sazimanje kosara u datoteci rezultata.
+	Zstandard daje omjer blizak LZMA-i uz brzinu blisku LZ4. Razine su 1-19 (do 22 za najbolji omjer),
+	a negativne razine su jos brze. Rjecnik se po zelji trenira posebno za svaki stupac iz njegovih
+	prvih kosara, sto najvise pomaze malim kosarama.
+	ZSTD se prevodi samo uz PI2TEST_ZSTD (i libzstd u linkeru); bez toga se sprema nesazeto.
+*/
+enum class Algoritam : uint8_t
+{
+	Bez = 0,
+	ZSTD = 1
+};
+
+struct PostavkeSazimanja
+{
+	Algoritam algoritam = Algoritam::Bez;
+	int razina = 3;
+	bool rjecnik = false;
+};
+
+inline bool ZSTDDostupan()
+{
+#ifdef PI2TEST_ZSTD
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef PI2TEST_ZSTD
+/* Kontekst po dretvi: stvara se pri prvoj kosari u dretvi i koristi za sve sljedece */
+inline ZSTD_CCtx* KontekstSazimanja()
+{
+	struct Kontekst
+	{
+		ZSTD_CCtx* c = ZSTD_createCCtx();
+		~Kontekst() { ZSTD_freeCCtx(c); }
+	};
+	static thread_local Kontekst k;
+	return k.c;
+}
+
+inline ZSTD_DCtx* KontekstRaspakiravanja()
+{
+	struct Kontekst
+	{
+		ZSTD_DCtx* d = ZSTD_createDCtx();
+		~Kontekst() { ZSTD_freeDCtx(d); }
+	};
+	static thread_local Kontekst k;
+	return k.d;
+}
+#endif
+
+/*
+	Rjecnik stupca: bajtovi kako se spremaju u datoteku i iz njih jednom pripremljen ZSTD_CDict
+	(za pisanje, na zadanoj razini) ili ZSTD_DDict (za citanje), pa se rjecnik ne obradjuje
+	iznova za svaku kosaru. Pripremljeni rjecnik smije se koristiti iz vise dretvi istovremeno.
+*/
+class RjecnikSazimanja
+{
+public:
+	/* Za raspakiravanje */
+	explicit RjecnikSazimanja(std::vector<uint8_t> bajtovi) : bajtovi(std::move(bajtovi))
+	{
+#ifdef PI2TEST_ZSTD
+		if (!this->bajtovi.empty() && !(ddict = ZSTD_createDDict(this->bajtovi.data(), this->bajtovi.size())))
+			throw std::runtime_error("Ne mogu pripremiti ZSTD rjecnik");
+#endif
+	}
+
+	/* Za sazimanje na razini razina */
+	RjecnikSazimanja(std::vector<uint8_t> bajtovi, int razina) : bajtovi(std::move(bajtovi))
+	{
+#ifdef PI2TEST_ZSTD
+		if (!this->bajtovi.empty() && !(cdict = ZSTD_createCDict(this->bajtovi.data(), this->bajtovi.size(), razina)))
+			throw std::runtime_error("Ne mogu pripremiti ZSTD rjecnik");
+#else
+		(void)razina;
+#endif
+	}
+
+	~RjecnikSazimanja()
+	{
+#ifdef PI2TEST_ZSTD
+		ZSTD_freeCDict(cdict);
+		ZSTD_freeDDict(ddict);
+#endif
+	}
+
+	RjecnikSazimanja(const RjecnikSazimanja&) = delete;
+	RjecnikSazimanja& operator=(const RjecnikSazimanja&) = delete;
+
+	const std::vector<uint8_t>& Bajtovi() const { return bajtovi; }
+
+#ifdef PI2TEST_ZSTD
+	const ZSTD_CDict* CDict() const { return cdict; }
+	const ZSTD_DDict* DDict() const { return ddict; }
+#endif
+
+private:
+	std::vector<uint8_t> bajtovi;
+#ifdef PI2TEST_ZSTD
+	ZSTD_CDict* cdict = nullptr;
+	ZSTD_DDict* ddict = nullptr;
+#endif
+};
+
+/*
+	Sazima n bajtova u dst, s rjecnikom ako nije nullptr. Vraca false ako sazimanje nije moguce
+	ili nije isplativo, pa pozivatelj tada sprema kosaru nesazetu.
+*/
+inline bool Sazmi(const PostavkeSazimanja& p, const RjecnikSazimanja* rjecnik, const uint8_t* src, size_t n, std::vector<uint8_t>& dst)
+{
+#ifdef PI2TEST_ZSTD
+	if (p.algoritam == Algoritam::ZSTD)
+	{
+		dst.resize(ZSTD_compressBound(n));
+		ZSTD_CCtx* cctx = KontekstSazimanja();
+		size_t r = rjecnik && rjecnik->CDict()
+			? ZSTD_compress_usingCDict(cctx, dst.data(), dst.size(), src, n, rjecnik->CDict())
+			: ZSTD_compressCCtx(cctx, dst.data(), dst.size(), src, n, p.razina);
+		if (ZSTD_isError(r) || r >= n)
+			return false;
+		dst.resize(r);
+		return true;
+	}
+#else
+	(void)p; (void)rjecnik; (void)src; (void)n; (void)dst;
+#endif
+	return false;
+}
+
+/* Raspakira kosaru tocno velicina bajtova; baca std::runtime_error ako podaci nisu ispravni */
+inline void Raspakiraj(Algoritam a, const RjecnikSazimanja* rjecnik, const uint8_t* src, size_t n, uint8_t* dst, size_t velicina)
+{
+	if (a == Algoritam::Bez)
+	{
+		if (n != velicina)
+			throw std::runtime_error("Neispravna velicina nesazete kosare");
+		std::copy(src, src + n, dst);
+		return;
+	}
+#ifdef PI2TEST_ZSTD
+	if (a == Algoritam::ZSTD)
+	{
+		ZSTD_DCtx* dctx = KontekstRaspakiravanja();
+		size_t r = rjecnik && rjecnik->DDict()
+			? ZSTD_decompress_usingDDict(dctx, dst, velicina, src, n, rjecnik->DDict())
+			: ZSTD_decompressDCtx(dctx, dst, velicina, src, n);
+		if (ZSTD_isError(r) || r != velicina)
+			throw std::runtime_error(std::string("Greska pri raspakiravanju ZSTD kosare: ") + (ZSTD_isError(r) ? ZSTD_getErrorName(r) : "kriva velicina"));
+		return;
+	}
+#else
+	(void)rjecnik;
+#endif
+	throw std::runtime_error("Kosara je sazeta algoritmom koji nije preveden (PI2TEST_ZSTD)");
+}
+
+/* Rjecnik od najvise velicina bajtova iz uzoraka; prazan ako treniranje ne uspije (npr. premalo podataka) */
+inline std::vector<uint8_t> TrenirajRjecnik(const std::vector<std::vector<uint8_t>>& uzorci, size_t velicina)
+{
+	std::vector<uint8_t> rjecnik;
+#ifdef PI2TEST_ZSTD
+	std::vector<uint8_t> sve;
+	std::vector<size_t> velicine;
+	for (const auto& u : uzorci)
+	{
+		sve.insert(sve.end(), u.begin(), u.end());
+		velicine.push_back(u.size());
+	}
+	rjecnik.resize(velicina);
+	size_t r = ZDICT_trainFromBuffer(rjecnik.data(), rjecnik.size(), sve.data(), velicine.data(), (unsigned)velicine.size());
+	if (ZDICT_isError(r))
+		rjecnik.clear();
+	else
+		rjecnik.resize(r);
+#else
+	(void)uzorci; (void)velicina;
+#endif
+	return rjecnik;
+}
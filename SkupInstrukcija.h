@@ -0,0 +1,61 @@
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PI2TEST_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/*
+	Skup SIMD instrukcija koji se bira pri izvodjenju (CPUID), pa isti program radi i na procesorima
+	bez AVX2. GCC i Clang jezgre za pojedini skup prevode s atributom target (PI2TEST_CILJ),
+	a MSVC intrinzike dopusta bez posebnih zastavica.
+*/
+
+#if defined(PI2TEST_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PI2TEST_CILJ(x) __attribute__((target(x)))
+#else
+#define PI2TEST_CILJ(x)
+#endif
+
+enum class SkupInstrukcija
+{
+	Skalarno = 0,
+	SSSE3 = 1,
+	AVX2 = 2
+};
+
+inline const char* ImeSkupa(SkupInstrukcija s)
+{
+	return s == SkupInstrukcija::AVX2 ? "AVX2" : s == SkupInstrukcija::SSSE3 ? "SSSE3" : "skalarno";
+}
+
+/* Najbolji skup instrukcija koji procesor (i operacijski sustav, za AVX registre) podrzava */
+inline SkupInstrukcija NajboljiSkupInstrukcija()
+{
+	static const SkupInstrukcija najbolji = [] {
+		bool ssse3 = false, avx2 = false;
+#if defined(PI2TEST_X86) && defined(_MSC_VER)
+		int r[4];
+		__cpuid(r, 0);
+		int maxFunkcija = r[0];
+		__cpuid(r, 1);
+		ssse3 = (r[2] & (1 << 9)) != 0;
+		bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+		if (maxFunkcija >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+		{
+			__cpuidex(r, 7, 0);
+			avx2 = (r[1] & (1 << 5)) != 0;
+		}
+#elif defined(PI2TEST_X86)
+		__builtin_cpu_init();
+		ssse3 = __builtin_cpu_supports("ssse3") != 0;
+		avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+		return avx2 ? SkupInstrukcija::AVX2 : ssse3 ? SkupInstrukcija::SSSE3 : SkupInstrukcija::Skalarno;
+	}();
+	return najbolji;
+}
+
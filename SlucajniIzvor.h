@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IzvorPodataka.h"
+
+/*
+	Generator s brojacem Philox4x32-10 (Salmon i sur., Random123): izlaz je funkcija kljuca i brojaca,
+	bez stanja koje bi se prenosilo s broja na broj. Kljuc je sjeme, a brojac (red, tok, i) pa su
+	brojevi reda isti bez obzira na to koja ih dretva, kojim redom i u kojem rasponu racuna.
+*/
+class Philox
+{
+public:
+	typedef uint32_t result_type;
+
+	/* Brojevi reda red u toku tok (npr. stupac), za zadano sjeme */
+	Philox(uint64_t sjeme, uint64_t red, uint32_t tok = 0)
+		: kljuc{ (uint32_t)sjeme, (uint32_t)(sjeme >> 32) }, brojac{ (uint32_t)red, (uint32_t)(red >> 32), tok, 0 }
+	{
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+	result_type operator()()
+	{
+		if (indeks == 4)
+		{
+			Blok(brojac, kljuc, blok);
+			brojac[3]++;
+			indeks = 0;
+		}
+		return blok[indeks++];
+	}
+
+	/* Jednoliko iz [0,1) s 53 bita */
+	double U01()
+	{
+		uint64_t a = (*this)() >> 5, b = (*this)() >> 6;
+		return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+	}
+
+	/* Deset krugova nad 128-bitnim brojacem */
+	static void Blok(const uint32_t* brojac, const uint32_t* kljuc, uint32_t* izlaz)
+	{
+		uint32_t c0 = brojac[0], c1 = brojac[1], c2 = brojac[2], c3 = brojac[3];
+		uint32_t k0 = kljuc[0], k1 = kljuc[1];
+		for (int krug = 0; krug < 10; krug++)
+		{
+			uint64_t p0 = (uint64_t)0xD2511F53u * c0, p1 = (uint64_t)0xCD9E8D57u * c2;
+			uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0, n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+			c0 = n0;
+			c1 = (uint32_t)p1;
+			c2 = n2;
+			c3 = (uint32_t)p0;
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+		izlaz[0] = c0;
+		izlaz[1] = c1;
+		izlaz[2] = c2;
+		izlaz[3] = c3;
+	}
+
+private:
+	uint32_t kljuc[2], brojac[4], blok[4] = {};
+	int indeks = 4;
+};
+
+/*
+	Izvor bez ulaznih podataka (kao prazni RDataFrame(N)) sa slucajnim stupcima. Red r stupca s
+	dobiva svoj Philox(sjeme, r, s) i svjezu kopiju razdiobe, pa vrijednost ovisi samo o (sjeme, r, s):
+	isti je rezultat s jednom dretvom i s mnogo njih, bez zajednickog generatora. Vrijednosti se
+	racunaju odjednom za cijeli raspon kad ga utor pocne, u medjuspremnik utora.
+*/
+class IzvorSlucajni : public IzvorPodataka
+{
+public:
+	explicit IzvorSlucajni(uint64_t brRedova, uint64_t velicinaRaspona = 4096) : brRedova(brRedova), velicinaRaspona(std::max<uint64_t>(1, velicinaRaspona)) {}
+
+	/* Stupac double vrijednosti razdiobe d (npr. std::uniform_real_distribution<double>) */
+	template <class D>
+	void DefinirajSlucajni(const std::string& ime, D d, uint64_t sjeme)
+	{
+		uint32_t tok = (uint32_t)imena.size();
+		imena.push_back(ime);
+		punila.push_back([d, sjeme, tok](uint64_t od, size_t n, double* izlaz) {
+			for (size_t i = 0; i < n; i++)
+			{
+				Philox g(sjeme, od + i, tok);
+				D razdioba(d);
+				izlaz[i] = (double)razdioba(g);
+			}
+		});
+	}
+
+	/* Jednoliki [a, b) s 53 bita, bez std razdiobe */
+	void DefinirajJednoliki(const std::string& ime, double a, double b, uint64_t sjeme)
+	{
+		uint32_t tok = (uint32_t)imena.size();
+		imena.push_back(ime);
+		punila.push_back([a, b, sjeme, tok](uint64_t od, size_t n, double* izlaz) {
+			for (size_t i = 0; i < n; i++)
+			{
+				Philox g(sjeme, od + i, tok);
+				izlaz[i] = a + (b - a) * g.U01();
+			}
+		});
+	}
+
+	std::vector<std::string> ImenaStupaca() const override { return imena; }
+
+	TipStupca Tip(const std::string& ime) const override
+	{
+		Indeks(ime);
+		return TipStupca::Double;
+	}
+
+	void PostaviBrojUtora(unsigned brUtora) override
+	{
+		utori = std::vector<Utor>(brUtora);
+		for (Utor& u : utori)
+		{
+			u.vrijednosti.resize(imena.size() * velicinaRaspona);
+			u.pokazivaci.resize(imena.size());
+		}
+	}
+
+	const void* const* CitacStupca(const std::string& ime, unsigned utor) override { return &utori[utor].pokazivaci[Indeks(ime)]; }
+
+	std::vector<std::pair<uint64_t, uint64_t>> RasponiRedova() const override
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> r;
+		for (uint64_t od = 0; od < brRedova; od += velicinaRaspona)
+			r.push_back({ od, std::min(brRedova, od + velicinaRaspona) });
+		return r;
+	}
+
+	void PocniRaspon(unsigned utor, uint64_t od) override
+	{
+		Utor& u = utori[utor];
+		size_t n = (size_t)(std::min(brRedova, od + velicinaRaspona) - od);
+		for (size_t s = 0; s < punila.size(); s++)
+			punila[s](od, n, u.vrijednosti.data() + s * velicinaRaspona);
+		u.od = od;
+	}
+
+	void PostaviRed(unsigned utor, uint64_t red) override
+	{
+		Utor& u = utori[utor];
+		size_t i = (size_t)(red - u.od);
+		for (size_t s = 0; s < u.pokazivaci.size(); s++)
+			u.pokazivaci[s] = &u.vrijednosti[s * velicinaRaspona + i];
+	}
+
+	size_t NajveciBlok() const override { return (size_t)velicinaRaspona; }
+
+private:
+	struct alignas(64) Utor
+	{
+		uint64_t od = 0;
+		std::vector<double> vrijednosti;
+		std::vector<const void*> pokazivaci;
+	};
+
+	size_t Indeks(const std::string& ime) const
+	{
+		for (size_t s = 0; s < imena.size(); s++)
+			if (imena[s] == ime)
+				return s;
+		throw std::runtime_error("Nema stupca " + ime);
+	}
+
+	uint64_t brRedova, velicinaRaspona;
+	std::vector<std::string> imena;
+	std::vector<std::function<void(uint64_t, size_t, double*)>> punila;
+	std::vector<Utor> utori;
+};
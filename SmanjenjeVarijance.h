@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+	Procjenitelj \pi s kontrolnim varijablama:
+		h(x,y) = 4 * [x^2 + y^2 <= 1] - suma_m c_m P_p(2x-1) P_q(2y-1)
+	gdje su P_n Legendreovi polinomi. Za (p,q) != (0,0) ocekivanje clana je 0, pa je ocekivanje h
+	i dalje \pi za bilo koje c. Polinomi su ortogonalni na [0,1]^2, pa je problem dobro uvjetovan,
+	za razliku od obicnih monoma x^p y^q.
+	Svaki poziv je jedan prolaz uzorkovanja s istim sjemenom (zajednicki slucajni brojevi),
+	pa je funkcija cilja glatka i deterministicka.
+*/
+struct KontrolneVarijable
+{
+	std::vector<std::pair<int, int>> clanovi;
+	int stupanj;
+	uint64_t brTocaka, sjeme;
+
+	/* Svi P_p P_q s 1 <= p+q <= stupanj */
+	KontrolneVarijable(int stupanj, uint64_t brTocaka, uint64_t sjeme) : stupanj(stupanj), brTocaka(brTocaka), sjeme(sjeme)
+	{
+		for (int s = 1; s <= stupanj; s++)
+			for (int p = s; p >= 0; p--)
+				clanovi.push_back({ p, s - p });
+	}
+
+	size_t BrojParametara() const { return clanovi.size(); }
+
+	/* Srednja vrijednost i varijanca jednog uzorka h za koeficijente c */
+	void Procijeni(const std::vector<double>& c, uint64_t sjemeUzorka, double& srVrij, double& var) const
+	{
+		std::mt19937_64 gen(sjemeUzorka);
+		std::uniform_real_distribution<double> U(0.0, 1.0);
+		std::vector<double> px(stupanj + 1), py(stupanj + 1);
+		px[0] = py[0] = 1.0;
+
+		double suma = 0.0, suma2 = 0.0;
+		for (uint64_t i = 0; i < brTocaka; i++)
+		{
+			double x = U(gen), y = U(gen);
+			double tx = 2 * x - 1, ty = 2 * y - 1;
+			if (stupanj >= 1)
+			{
+				px[1] = tx;
+				py[1] = ty;
+			}
+			for (int s = 1; s < stupanj; s++)
+			{
+				px[s + 1] = ((2 * s + 1) * tx * px[s] - s * px[s - 1]) / (s + 1);
+				py[s + 1] = ((2 * s + 1) * ty * py[s] - s * py[s - 1]) / (s + 1);
+			}
+			double h = (x * x + y * y <= 1.0) ? 4.0 : 0.0;
+			for (size_t m = 0; m < clanovi.size(); m++)
+				h -= c[m] * px[clanovi[m].first] * py[clanovi[m].second];
+			suma += h;
+			suma2 += h * h;
+		}
+		srVrij = suma / brTocaka;
+		var = suma2 / brTocaka - srVrij * srVrij;
+	}
+
+	/* Funkcija cilja: varijanca procjenitelja na fiksnom uzorku */
+	double operator()(const std::vector<double>& c) const
+	{
+		double srVrij, var;
+		Procijeni(c, sjeme, srVrij, var);
+		return var;
+	}
+};
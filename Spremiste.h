@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/*
+	Prirucno spremiste obrade na disku: rezultat skupe obrade (npr. \pi-jevi po eksponentu procitani
+	iz velike datoteke) sprema se pod 64-bitnim kljucem, pa ponovljeni posao s istim ulazom samo
+	procita jednu malu datoteku. Kljuc je sazetak svega o cemu rezultat ovisi: imena, velicine i
+	vremena izmjene ulazne datoteke te opisa i verzije obrade, pa izmijenjena datoteka ili druga
+	obrada uvijek promasuju.
+
+	Svaki kljuc je datoteka <direktorij>/<kljuc hex>.bin: "PI2C", verzija u32, kljuc u64,
+	broj stupaca u64, za svaki stupac broj vrijednosti u64 i vrijednosti. Zapis ide u privremenu
+	datoteku koja se zatim preimenuje, pa prekinuti zapis ne ostavlja pokvaren ulaz.
+*/
+
+const uint32_t SPREM_VERZIJA = 1;
+
+/* FNV-1a, nastavlja se od h */
+inline uint64_t Sazetak(const void* podaci, size_t n, uint64_t h = 14695981039346656037ull)
+{
+	const uint8_t* p = (const uint8_t*)podaci;
+	for (size_t i = 0; i < n; i++)
+		h = (h ^ p[i]) * 1099511628211ull;
+	return h;
+}
+
+inline uint64_t SazetakTeksta(const std::string& s, uint64_t h = 14695981039346656037ull)
+{
+	/* Duljina ide u sazetak da se ("ab", "c") i ("a", "bc") razlikuju */
+	uint64_t n = s.size();
+	return Sazetak(s.data(), s.size(), Sazetak(&n, sizeof(n), h));
+}
+
+/* Sazetak imena, velicine i vremena izmjene datoteke; sadrzaj se ne cita */
+inline uint64_t SazetakDatoteke(const std::string& ime, uint64_t h = 14695981039346656037ull)
+{
+	namespace fs = std::filesystem;
+	std::error_code ec;
+	fs::path put = fs::absolute(ime, ec);
+	uint64_t velicina = (uint64_t)fs::file_size(ime, ec);
+	int64_t vrijeme = (int64_t)fs::last_write_time(ime, ec).time_since_epoch().count();
+	h = SazetakTeksta(ec ? ime : put.string(), h);
+	h = Sazetak(&velicina, sizeof(velicina), h);
+	return Sazetak(&vrijeme, sizeof(vrijeme), h);
+}
+
+class Spremiste
+{
+public:
+	explicit Spremiste(const std::string& direktorij = ".pi2spremiste") : direktorij(direktorij) {}
+
+	/* Vraca false ako nema ulaza za kljuc ili je ulaz neispravan */
+	bool Ucitaj(uint64_t kljuc, std::vector<std::vector<double>>& stupci) const
+	{
+		std::ifstream dat(Ime(kljuc), std::ios::binary | std::ios::ate);
+		if (!dat)
+			return false;
+		/* Duljine iz datoteke provjeravaju se prema ostatku datoteke, pa pokvaren ulaz ne trazi golemu memoriju */
+		uint64_t ostatak = (uint64_t)dat.tellg();
+		dat.seekg(0);
+		char magija[4];
+		uint32_t verzija;
+		uint64_t k, brStupaca;
+		dat.read(magija, 4);
+		dat.read((char*)&verzija, sizeof(verzija));
+		dat.read((char*)&k, sizeof(k));
+		dat.read((char*)&brStupaca, sizeof(brStupaca));
+		const uint64_t zaglavlje = 4 + sizeof(verzija) + sizeof(k) + sizeof(brStupaca);
+		if (!dat || std::string(magija, 4) != "PI2C" || verzija != SPREM_VERZIJA || k != kljuc || ostatak < zaglavlje)
+			return false;
+		ostatak -= zaglavlje;
+		if (brStupaca > ostatak / sizeof(uint64_t))
+			return false;
+		std::vector<std::vector<double>> s(brStupaca);
+		for (auto& stupac : s)
+		{
+			uint64_t n;
+			if (!dat.read((char*)&n, sizeof(n)))
+				return false;
+			ostatak -= sizeof(n);
+			if (n > ostatak / sizeof(double))
+				return false;
+			ostatak -= n * sizeof(double);
+			stupac.resize(n);
+			dat.read((char*)stupac.data(), n * sizeof(double));
+		}
+		if (!dat)
+			return false;
+		stupci.swap(s);
+		return true;
+	}
+
+	/* Baca std::runtime_error ako zapis ne uspije */
+	void Spremi(uint64_t kljuc, const std::vector<std::vector<double>>& stupci) const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(direktorij, ec);
+		std::string ime = Ime(kljuc), privremeno = ime + ".tmp";
+		{
+			std::ofstream dat(privremeno, std::ios::binary | std::ios::trunc);
+			uint64_t brStupaca = stupci.size();
+			dat.write("PI2C", 4);
+			dat.write((const char*)&SPREM_VERZIJA, sizeof(SPREM_VERZIJA));
+			dat.write((const char*)&kljuc, sizeof(kljuc));
+			dat.write((const char*)&brStupaca, sizeof(brStupaca));
+			for (const auto& stupac : stupci)
+			{
+				uint64_t n = stupac.size();
+				dat.write((const char*)&n, sizeof(n));
+				dat.write((const char*)stupac.data(), n * sizeof(double));
+			}
+			if (!dat.flush())
+				throw std::runtime_error("Ne mogu pisati u prirucno spremiste " + privremeno);
+		}
+		std::filesystem::rename(privremeno, ime, ec);
+		if (ec)
+		{
+			std::remove(privremeno.c_str());
+			throw std::runtime_error("Ne mogu pisati u prirucno spremiste " + ime);
+		}
+	}
+
+	std::string Ime(uint64_t kljuc) const
+	{
+		char hex[17];
+		std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)kljuc);
+		return (std::filesystem::path(direktorij) / (std::string(hex) + ".bin")).string();
+	}
+
+private:
+	std::string direktorij;
+};
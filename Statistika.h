@@ -0,0 +1,374 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+	Srednja vrijednost i standardna devijacija po eksponentu (stupcu) tablice BrPi[j][k].
+	sqrt(suma(x_i - x_sr)^2/n). Stupci ne moraju biti iste duljine; prazan stupac ostaje 0.
+*/
+inline void SrVrijStDev(const std::vector<std::vector<double>>& BrPi, std::vector<double>& srVrij, std::vector<double>& stDev)
+{
+	size_t n = BrPi.size();
+	srVrij.assign(n, 0.0);
+	stDev.assign(n, 0.0);
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t brPon = BrPi[i].size();
+		if (brPon == 0)
+			continue;
+		for (size_t j = 0; j < brPon; j++)
+			srVrij[i] += BrPi[i][j];
+		srVrij[i] = srVrij[i] / ((double)brPon);
+		for (size_t j = 0; j < brPon; j++)
+			stDev[i] += pow(BrPi[i][j] - srVrij[i], 2);
+		stDev[i] = sqrt(stDev[i] / ((double)brPon));
+	}
+}
+
+/* Kolmogorovljeva razdioba: Q(lambda) = 2 suma (-1)^(j-1) exp(-2 j^2 lambda^2) */
+inline double KolmogorovQ(double lambda)
+{
+	if (lambda < 0.2)
+		return 1.0;
+	double suma = 0.0, predznak = 1.0;
+	for (int j = 1; j <= 100; j++)
+	{
+		double clan = predznak * 2.0 * exp(-2.0 * j * j * lambda * lambda);
+		suma += clan;
+		if (fabs(clan) < 1e-12 * fabs(suma))
+			break;
+		predznak = -predznak;
+	}
+	return std::min(1.0, std::max(0.0, suma));
+}
+
+/*
+	Dvouzorcni Kolmogorov-Smirnov test. Vraca p-vrijednost, a u D sprema najvecu
+	razliku empirijskih funkcija razdiobe. Za diskretne uzorke (mali 10^j) test je konzervativan.
+	Za prazan uzorak vraca 1 uz D = 0.
+*/
+inline double KSTest2(std::vector<double> a, std::vector<double> b, double* D = nullptr)
+{
+	if (D)
+		*D = 0.0;
+	if (a.empty() || b.empty())
+		return 1.0;
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	double na = (double)a.size(), nb = (double)b.size(), d = 0.0;
+	size_t i = 0, j = 0;
+	while (i < a.size() && j < b.size())
+	{
+		double x = std::min(a[i], b[j]);
+		while (i < a.size() && a[i] <= x)
+			i++;
+		while (j < b.size() && b[j] <= x)
+			j++;
+		d = std::max(d, fabs(i / na - j / nb));
+	}
+	if (D)
+		*D = d;
+	double en = sqrt(na * nb / (na + nb));
+	return KolmogorovQ((en + 0.12 + 0.11 / en) * d);
+}
+
+/*
+	p-vrijednost standardiziranog Anderson-Darling T za k = 2 uzorka, interpolacijom
+	log(p/(1-p)) po tablici Scholz & Stephens (1987).
+*/
+inline double ADPVrijednost(double T)
+{
+	static const double t[] = { 0.326, 1.225, 1.960, 2.719, 3.752, 4.592, 6.546 };
+	static const double p[] = { 0.25, 0.10, 0.05, 0.025, 0.01, 0.005, 0.001 };
+	const int m = sizeof(t) / sizeof(t[0]);
+	int i = 0;
+	while (i < m - 2 && T > t[i + 1])
+		i++;
+	double l0 = log(p[i] / (1 - p[i])), l1 = log(p[i + 1] / (1 - p[i + 1]));
+	double l = l0 + (T - t[i]) * (l1 - l0) / (t[i + 1] - t[i]);
+	return 1.0 / (1.0 + exp(-l));
+}
+
+/*
+	Dvouzorcni Anderson-Darling test (Scholz & Stephens, inacica A2_akN za uzorke s izjednacenjima).
+	Vraca p-vrijednost, a u T sprema standardiziranu statistiku (A2 - 1) / sigma.
+	Ako neki uzorak ima manje od 2 vrijednosti, vraca 1 uz T = 0.
+*/
+inline double ADTest2(const std::vector<double>& a, const std::vector<double>& b, double* T = nullptr)
+{
+	if (T)
+		*T = 0.0;
+	std::vector<std::pair<double, int>> z;
+	z.reserve(a.size() + b.size());
+	for (double x : a)
+		z.push_back({ x, 0 });
+	for (double x : b)
+		z.push_back({ x, 1 });
+	std::sort(z.begin(), z.end());
+
+	double na = (double)a.size(), nb = (double)b.size(), N = na + nb;
+	if (na < 2 || nb < 2)
+		return 1.0;
+
+	double A2 = 0.0, B = 0.0, M1 = 0.0, M2 = 0.0;
+	for (size_t i = 0; i < z.size();)
+	{
+		double f1 = 0.0, f2 = 0.0;
+		size_t j = i;
+		for (; j < z.size() && z[j].first == z[i].first; j++)
+			(z[j].second == 0 ? f1 : f2) += 1.0;
+		double l = f1 + f2;
+		B += l;
+		M1 += f1;
+		M2 += f2;
+		double Ba = B - l / 2, Ma1 = M1 - f1 / 2, Ma2 = M2 - f2 / 2;
+		double nazivnik = Ba * (N - Ba) - N * l / 4;
+		if (nazivnik > 0)
+			A2 += l * (pow(N * Ma1 - na * Ba, 2) / na + pow(N * Ma2 - nb * Ba, 2) / nb) / nazivnik;
+		i = j;
+	}
+	A2 *= (N - 1) / (N * N);
+
+	/* Varijanca A2 uz k = 2 */
+	const double k = 2.0;
+	double H = 1.0 / na + 1.0 / nb, h = 0.0, g = 0.0;
+	long long Ni = (long long)N;
+	std::vector<double> hi(Ni, 0.0);
+	for (long long i = 1; i < Ni; i++)
+		hi[i] = hi[i - 1] + 1.0 / i;
+	h = hi[Ni - 1];
+	for (long long i = 1; i <= Ni - 2; i++)
+		g += (h - hi[i]) / (N - i);
+	double ca = (4 * g - 6) * (k - 1) + (10 - 6 * g) * H;
+	double cb = (2 * g - 4) * k * k + 8 * h * k + (2 * g - 14 * h - 4) * H - 8 * h + 4 * g - 6;
+	double cc = (6 * h + 2 * g - 2) * k * k + (4 * h - 4 * g + 6) * k + (2 * h - 6) * H + 4 * h;
+	double cd = (2 * h + 6) * k * k - 4 * h * k;
+	double var = (ca * N * N * N + cb * N * N + cc * N + cd) / ((N - 1) * (N - 2) * (N - 3));
+
+	double t = (A2 - (k - 1)) / sqrt(var);
+	if (T)
+		*T = t;
+	return ADPVrijednost(t);
+}
+
+/* Regularizirana gama funkcija P(a,x) (red za x < a+1, inace verizni razlomak za Q) */
+inline double GamaP(double a, double x)
+{
+	if (x <= 0.0)
+		return 0.0;
+	double lnPred = a * log(x) - x - lgamma(a);
+	if (x < a + 1.0)
+	{
+		double ap = a, del = 1.0 / a, suma = del;
+		for (int n = 0; n < 1000000; n++)
+		{
+			ap += 1.0;
+			del *= x / ap;
+			suma += del;
+			if (fabs(del) < fabs(suma) * 1e-15)
+				break;
+		}
+		return std::min(1.0, suma * exp(lnPred));
+	}
+	const double malo = 1e-300;
+	double b = x + 1.0 - a, c = 1.0 / malo, d = 1.0 / b, h = d;
+	for (int i = 1; i < 1000000; i++)
+	{
+		double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b;
+		if (fabs(d) < malo)
+			d = malo;
+		c = b + an / c;
+		if (fabs(c) < malo)
+			c = malo;
+		d = 1.0 / d;
+		double del = d * c;
+		h *= del;
+		if (fabs(del - 1.0) < 1e-15)
+			break;
+	}
+	return std::max(0.0, 1.0 - exp(lnPred) * h);
+}
+
+/* Q(a,x) = 1 - P(a,x) */
+inline double GamaQ(double a, double x)
+{
+	return 1.0 - GamaP(a, x);
+}
+
+/* p-vrijednost chi^2 testa s dof stupnjeva slobode */
+inline double Chi2PVrijednost(double chi2, double dof)
+{
+	return GamaQ(dof / 2.0, chi2 / 2.0);
+}
+
+/* Dvostrana p-vrijednost za opazeni broj k iz Poissonove razdiobe s ocekivanjem lambda */
+inline double PoissonPVrijednost(double k, double lambda)
+{
+	double manje = GamaQ(k + 1.0, lambda);           /* P(X <= k) */
+	double vece = k > 0 ? GamaP(k, lambda) : 1.0;    /* P(X >= k) */
+	return std::min(1.0, 2.0 * std::min(manje, vece));
+}
+
+/* Asimptotska p-vrijednost jednouzorcnog Anderson-Darling A2 (Marsaglia & Marsaglia, 2004) */
+inline double ADInfPVrijednost(double z)
+{
+	if (z <= 0.0)
+		return 1.0;
+	double F;
+	if (z < 2.0)
+		F = exp(-1.2337141 / z) / sqrt(z) * (2.00012 + (.247105 - (.0649821 - (.0347962 - (.011672 - .00168691 * z) * z) * z) * z) * z);
+	else
+		F = exp(-exp(1.0776 - (2.30695 - (.43424 - (.082433 - (.008056 - .0003146 * z) * z) * z) * z) * z));
+	return std::min(1.0, std::max(0.0, 1.0 - F));
+}
+
+/*
+	Jednouzorcni test jednolikosti na [0,1): Kolmogorov-Smirnov (p-vrijednost se vraca, D se sprema)
+	i Anderson-Darling (A2 i p-vrijednost se spremaju u pAD). Uzorak se sortira na mjestu.
+*/
+inline double KSTestJednolik(std::vector<double>& u, double* D = nullptr, double* A2 = nullptr, double* pAD = nullptr)
+{
+	if (u.empty())
+		return 1.0;
+	std::sort(u.begin(), u.end());
+	double m = (double)u.size(), d = 0.0, a2 = 0.0;
+	for (size_t i = 0; i < u.size(); i++)
+	{
+		d = std::max(d, std::max((i + 1) / m - u[i], u[i] - i / m));
+		double ui = std::min(std::max(u[i], 1e-300), 1.0 - 1e-16);
+		double uj = std::min(std::max(u[u.size() - 1 - i], 1e-300), 1.0 - 1e-16);
+		a2 += (2.0 * i + 1.0) * (log(ui) + log(1.0 - uj));
+	}
+	a2 = -m - a2 / m;
+	if (D)
+		*D = d;
+	if (A2)
+		*A2 = a2;
+	if (pAD)
+		*pAD = ADInfPVrijednost(a2);
+	double en = sqrt(m);
+	return KolmogorovQ((en + 0.12 + 0.11 / en) * d);
+}
+
+/* Kvantil standardne normalne razdiobe (Acklam) s jednim Halleyevim korakom preko erfc */
+inline double NormalniKvantil(double p)
+{
+	if (p <= 0.0)
+		return -HUGE_VAL;
+	if (p >= 1.0)
+		return HUGE_VAL;
+	static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+	double x;
+	if (p < 0.02425 || p > 1.0 - 0.02425)
+	{
+		double q = sqrt(-2.0 * log(p < 0.5 ? p : 1.0 - p));
+		x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+		if (p > 0.5)
+			x = -x;
+	}
+	else
+	{
+		double q = p - 0.5, r = q * q;
+		x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+	}
+	double e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+	double u = e * sqrt(2.0 * 3.14159265358979323846) * exp(x * x / 2.0);
+	return x - u / (1.0 + x * u / 2.0);
+}
+
+/* Verizni razlomak za nepotpunu beta funkciju (Lentz); konvergira brzo za x < (a+1)/(a+b+2) */
+inline double BetaVerizni(double a, double b, double x)
+{
+	const double malo = 1e-300;
+	double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+	double c = 1.0, d = 1.0 - qab * x / qap;
+	if (fabs(d) < malo)
+		d = malo;
+	d = 1.0 / d;
+	double h = d;
+	for (int m = 1; m < 100000000; m++)
+	{
+		double m2 = 2.0 * m;
+		double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+		d = 1.0 + aa * d;
+		if (fabs(d) < malo)
+			d = malo;
+		c = 1.0 + aa / c;
+		if (fabs(c) < malo)
+			c = malo;
+		d = 1.0 / d;
+		h *= d * c;
+		aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+		d = 1.0 + aa * d;
+		if (fabs(d) < malo)
+			d = malo;
+		c = 1.0 + aa / c;
+		if (fabs(c) < malo)
+			c = malo;
+		d = 1.0 / d;
+		double del = d * c;
+		h *= del;
+		if (fabs(del - 1.0) < 1e-15)
+			break;
+	}
+	return h;
+}
+
+/* Regularizirana nepotpuna beta funkcija I_x(a,b) */
+inline double BetaI(double a, double b, double x)
+{
+	if (x <= 0.0)
+		return 0.0;
+	if (x >= 1.0)
+		return 1.0;
+	double lnPred = lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log1p(-x);
+	if (x < (a + 1.0) / (a + b + 2.0))
+		return std::min(1.0, exp(lnPred) * BetaVerizni(a, b, x) / a);
+	return std::max(0.0, 1.0 - exp(lnPred) * BetaVerizni(b, a, 1.0 - x) / b);
+}
+
+/*
+	Kvantil beta razdiobe: x takav da je I_x(a,b) = p. Newton od normalne aproksimacije,
+	a korak koji izadje iz intervala u kojem je rjesenje zamjenjuje se raspolavljanjem.
+*/
+inline double BetaKvantil(double a, double b, double p)
+{
+	if (p <= 0.0)
+		return 0.0;
+	if (p >= 1.0)
+		return 1.0;
+	double lnB = lgamma(a) + lgamma(b) - lgamma(a + b);
+	double sr = a / (a + b), sd = sqrt(a * b / ((a + b) * (a + b) * (a + b + 1.0)));
+	double x = sr + sd * NormalniKvantil(p);
+	if (!(x > 0.0 && x < 1.0))
+		x = sr;
+	double lo = 0.0, hi = 1.0;
+	for (int i = 0; i < 300; i++)
+	{
+		double f = BetaI(a, b, x) - p;
+		if (f == 0.0)
+			break;
+		if (f < 0.0)
+			lo = x;
+		else
+			hi = x;
+		double gustoca = exp((a - 1.0) * log(x) + (b - 1.0) * log1p(-x) - lnB);
+		double novi = gustoca > 0.0 ? x - f / gustoca : 0.5 * (lo + hi);
+		if (!(novi > lo && novi < hi))
+			novi = 0.5 * (lo + hi);
+		if (fabs(novi - x) <= 1e-15 * x || hi - lo <= 1e-15 * x)
+		{
+			x = novi;
+			break;
+		}
+		x = novi;
+	}
+	return x;
+}
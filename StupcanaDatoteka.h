@@ -0,0 +1,542 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "IzvorPodataka.h"
+#include "Rezultati.h"
+
+/*
+	Stupcana datoteka za brzo spremanje tijekom uzorkovanja, bez kosara i sazimanja.
+	Izgled (sve u poretku bajtova racunala koje pise, oznaka kao u datoteci rezultata):
+		stranica 0: "PI2S", verzija u32, oznaka poretka u32, broj stupaca u32, redova po komadu u32,
+		            rezervirano u32, broj redova u64, broj komada u64, pomak statistike u64,
+		            za svaki stupac: ime char[32], tip u8, 7 bajtova popune
+		komadi:     komad k je na STRANICA + k * velicinaKomada; u njemu je stupac s niz od
+		            redovaPoKomadu vrijednosti na pomaku s * redovaPoKomadu * 8
+		statistika: za svaki komad i stupac najmanja i najveca vrijednost (u tipu stupca)
+	Svi zapisi su visekratnici stranice i pocinju na granici stranice, pa se mogu pisati
+	bez medjuspremnika operacijskog sustava (O_DIRECT, FILE_FLAG_NO_BUFFERING). Zadnji komad
+	se zapisuje cijeli; broj redova u zaglavlju govori koliko ih vrijedi.
+	Citanje mapira datoteku u memoriju, pa je stupac komada samo pokazivac u mapiranu datoteku.
+*/
+
+const uint32_t STUP_VERZIJA = 1;
+const size_t STUP_STRANICA = 4096;
+const size_t STUP_MAX_STUPACA = 64;
+const size_t STUP_IME = 32;
+
+struct ZaglavljeStupaca
+{
+	char magija[4];
+	uint32_t verzija, oznaka, brStupaca, redovaPoKomadu, rezervirano;
+	uint64_t brRedova, brKomada, pomakStatistike;
+	struct
+	{
+		char ime[STUP_IME];
+		uint8_t tip;
+		uint8_t popuna[7];
+	} stupci[STUP_MAX_STUPACA];
+};
+
+/* Memorija poravnata na stranicu, kakvu trazi pisanje bez medjuspremnika */
+inline void* PoravnataMemorija(size_t velicina)
+{
+#ifdef _WIN32
+	void* p = _aligned_malloc(velicina, STUP_STRANICA);
+#else
+	void* p = nullptr;
+	if (posix_memalign(&p, STUP_STRANICA, velicina) != 0)
+		p = nullptr;
+#endif
+	if (!p)
+		throw std::bad_alloc();
+	std::memset(p, 0, velicina);
+	return p;
+}
+
+inline void OslobodiPoravnatu(void* p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+/* Datoteka za pisanje na zadane pomake; bezMedjuspremnika trazi O_DIRECT, ali radi i ako ga sustav odbije */
+class DatotekaZaPisanje
+{
+public:
+	DatotekaZaPisanje(const std::string& ime, bool bezMedjuspremnika)
+	{
+#ifdef _WIN32
+		DWORD zastavice = FILE_ATTRIBUTE_NORMAL | (bezMedjuspremnika ? FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH : 0);
+		h = CreateFileA(ime.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, zastavice, nullptr);
+		if (h == INVALID_HANDLE_VALUE && bezMedjuspremnika)
+			h = CreateFileA(ime.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (h == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+		izravno = bezMedjuspremnika;
+#else
+		int zastavice = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+		if (bezMedjuspremnika)
+		{
+			fd = open(ime.c_str(), zastavice | O_DIRECT, 0644);
+			izravno = fd >= 0;
+		}
+#endif
+		if (fd < 0)
+			fd = open(ime.c_str(), zastavice, 0644);
+		if (fd < 0)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+#endif
+	}
+
+	~DatotekaZaPisanje()
+	{
+#ifdef _WIN32
+		if (h != INVALID_HANDLE_VALUE)
+			CloseHandle(h);
+#else
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+
+	DatotekaZaPisanje(const DatotekaZaPisanje&) = delete;
+	DatotekaZaPisanje& operator=(const DatotekaZaPisanje&) = delete;
+
+	bool Izravno() const { return izravno; }
+
+	void Pisi(const void* p, size_t n, uint64_t pomak)
+	{
+#ifdef _WIN32
+		OVERLAPPED o = {};
+		o.Offset = (DWORD)pomak;
+		o.OffsetHigh = (DWORD)(pomak >> 32);
+		DWORD zapisano = 0;
+		if (!WriteFile(h, p, (DWORD)n, &zapisano, &o) || zapisano != n)
+			throw std::runtime_error("Greska pri pisanju stupcane datoteke");
+#else
+		const char* c = (const char*)p;
+		while (n > 0)
+		{
+			ssize_t r = pwrite(fd, c, n, (off_t)pomak);
+			if (r <= 0)
+				throw std::runtime_error("Greska pri pisanju stupcane datoteke");
+			c += r;
+			n -= (size_t)r;
+			pomak += (uint64_t)r;
+		}
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE h = INVALID_HANDLE_VALUE;
+#else
+	int fd = -1;
+#endif
+	bool izravno = false;
+};
+
+/* Cijela datoteka mapirana u memoriju samo za citanje */
+class MapiranaDatoteka
+{
+public:
+	explicit MapiranaDatoteka(const std::string& ime)
+	{
+#ifdef _WIN32
+		h = CreateFileA(ime.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (h == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+		LARGE_INTEGER v;
+		GetFileSizeEx(h, &v);
+		velicina = (size_t)v.QuadPart;
+		if (velicina > 0)
+		{
+			mapa = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapa)
+				podaci = (const uint8_t*)MapViewOfFile(mapa, FILE_MAP_READ, 0, 0, 0);
+		}
+#else
+		fd = open(ime.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("Ne mogu otvoriti datoteku " + ime);
+		struct stat st;
+		fstat(fd, &st);
+		velicina = (size_t)st.st_size;
+		if (velicina > 0)
+		{
+			void* p = mmap(nullptr, velicina, PROT_READ, MAP_SHARED, fd, 0);
+			podaci = p == MAP_FAILED ? nullptr : (const uint8_t*)p;
+		}
+#endif
+		if (!podaci)
+		{
+			Zatvori();
+			throw std::runtime_error("Ne mogu mapirati datoteku " + ime);
+		}
+	}
+
+	~MapiranaDatoteka() { Zatvori(); }
+
+	MapiranaDatoteka(const MapiranaDatoteka&) = delete;
+	MapiranaDatoteka& operator=(const MapiranaDatoteka&) = delete;
+
+	const uint8_t* Podaci() const { return podaci; }
+	size_t Velicina() const { return velicina; }
+
+private:
+	void Zatvori()
+	{
+#ifdef _WIN32
+		if (podaci)
+			UnmapViewOfFile(podaci);
+		if (mapa)
+			CloseHandle(mapa);
+		if (h != INVALID_HANDLE_VALUE)
+			CloseHandle(h);
+		mapa = nullptr;
+		h = INVALID_HANDLE_VALUE;
+#else
+		if (podaci)
+			munmap((void*)podaci, velicina);
+		if (fd >= 0)
+			close(fd);
+		fd = -1;
+#endif
+		podaci = nullptr;
+	}
+
+#ifdef _WIN32
+	HANDLE h = INVALID_HANDLE_VALUE, mapa = nullptr;
+#else
+	int fd = -1;
+#endif
+	const uint8_t* podaci = nullptr;
+	size_t velicina = 0;
+};
+
+/*
+	Pisanje stupcane datoteke. Popuni() samo kopira 8 bajtova po stupcu u komad u memoriji;
+	pun komad se zapise jednim pozivom, a najmanja i najveca vrijednost stupca u komadu
+	racunaju se tada jednom petljom po stupcu.
+*/
+class PisacStupaca
+{
+public:
+	PisacStupaca(const std::string& ime, bool bezMedjuspremnika = false, uint32_t redovaPoKomadu = 65536)
+		: dat(ime, bezMedjuspremnika), redovaPoKomadu(std::max<uint32_t>(512, redovaPoKomadu - redovaPoKomadu % 512))
+	{
+	}
+
+	~PisacStupaca()
+	{
+		try
+		{
+			Zatvori();
+		}
+		catch (...)
+		{
+		}
+		if (komad)
+			OslobodiPoravnatu(komad);
+	}
+
+	/* Stupac cita vrijednost s adrese pri svakom Popuni() */
+	void Stupac(const std::string& ime, const double* adresa) { DodajStupac(ime, TipStupca::Double, adresa); }
+	void Stupac(const std::string& ime, const int64_t* adresa) { DodajStupac(ime, TipStupca::Int64, adresa); }
+
+	void Popuni()
+	{
+		if (!komad)
+			Zapocni();
+		uint8_t* p = komad + redUKomadu * 8;
+		for (size_t s = 0; s < adrese.size(); s++, p += (size_t)redovaPoKomadu * 8)
+			std::memcpy(p, adrese[s], 8);
+		brRedova++;
+		if (++redUKomadu == redovaPoKomadu)
+			IsprazniKomad();
+	}
+
+	/* Zapisuje zadnji komad, statistiku i zaglavlje; baca std::runtime_error ako pisanje ne uspije */
+	void Zatvori()
+	{
+		if (zatvoreno)
+			return;
+		zatvoreno = true;
+		if (!komad)
+			Zapocni();
+		if (redUKomadu > 0)
+			IsprazniKomad();
+
+		uint64_t pomakStatistike = STUP_STRANICA + brKomada * velicinaKomada;
+		size_t bajtovaStatistike = statistika.size() * 8;
+		size_t zaokruzeno = (bajtovaStatistike + STUP_STRANICA - 1) / STUP_STRANICA * STUP_STRANICA;
+		if (zaokruzeno > 0)
+		{
+			uint8_t* buf = (uint8_t*)PoravnataMemorija(zaokruzeno);
+			std::memcpy(buf, statistika.data(), bajtovaStatistike);
+			try
+			{
+				dat.Pisi(buf, zaokruzeno, pomakStatistike);
+			}
+			catch (...)
+			{
+				OslobodiPoravnatu(buf);
+				throw;
+			}
+			OslobodiPoravnatu(buf);
+		}
+
+		ZaglavljeStupaca* z = (ZaglavljeStupaca*)PoravnataMemorija(STUP_STRANICA);
+		std::memcpy(z->magija, "PI2S", 4);
+		z->verzija = STUP_VERZIJA;
+		z->oznaka = REZ_OZNAKA_PORETKA;
+		z->brStupaca = (uint32_t)adrese.size();
+		z->redovaPoKomadu = redovaPoKomadu;
+		z->brRedova = brRedova;
+		z->brKomada = brKomada;
+		z->pomakStatistike = pomakStatistike;
+		for (size_t s = 0; s < adrese.size(); s++)
+		{
+			std::strncpy(z->stupci[s].ime, imena[s].c_str(), STUP_IME - 1);
+			z->stupci[s].tip = (uint8_t)tipovi[s];
+		}
+		try
+		{
+			dat.Pisi(z, STUP_STRANICA, 0);
+		}
+		catch (...)
+		{
+			OslobodiPoravnatu(z);
+			throw;
+		}
+		OslobodiPoravnatu(z);
+	}
+
+	uint64_t BrojRedova() const { return brRedova; }
+	uint64_t BajtovaZapisano() const { return STUP_STRANICA + brKomada * velicinaKomada; }
+	bool BezMedjuspremnika() const { return dat.Izravno(); }
+
+private:
+	void DodajStupac(const std::string& ime, TipStupca tip, const void* adresa)
+	{
+		if (komad)
+			throw std::runtime_error("Stupci se dodaju prije prvog Popuni()");
+		if (adrese.size() == STUP_MAX_STUPACA || ime.size() >= STUP_IME)
+			throw std::runtime_error("Previse stupaca ili predugo ime stupca " + ime);
+		imena.push_back(ime);
+		tipovi.push_back(tip);
+		adrese.push_back(adresa);
+	}
+
+	void Zapocni()
+	{
+		velicinaKomada = std::max<size_t>(1, adrese.size()) * redovaPoKomadu * 8;
+		komad = (uint8_t*)PoravnataMemorija(velicinaKomada);
+	}
+
+	void IsprazniKomad()
+	{
+		for (size_t s = 0; s < adrese.size(); s++)
+		{
+			const uint8_t* stupac = komad + s * redovaPoKomadu * 8;
+			if (tipovi[s] == TipStupca::Double)
+				MinMax<double>(stupac);
+			else
+				MinMax<int64_t>(stupac);
+		}
+		dat.Pisi(komad, velicinaKomada, STUP_STRANICA + brKomada * velicinaKomada);
+		brKomada++;
+		redUKomadu = 0;
+	}
+
+	template <class T>
+	void MinMax(const uint8_t* stupac)
+	{
+		const T* v = (const T*)stupac;
+		T mn = v[0], mx = v[0];
+		for (uint32_t i = 1; i < redUKomadu; i++)
+		{
+			mn = v[i] < mn ? v[i] : mn;
+			mx = v[i] > mx ? v[i] : mx;
+		}
+		uint64_t b;
+		std::memcpy(&b, &mn, 8);
+		statistika.push_back(b);
+		std::memcpy(&b, &mx, 8);
+		statistika.push_back(b);
+	}
+
+	DatotekaZaPisanje dat;
+	uint32_t redovaPoKomadu;
+	std::vector<std::string> imena;
+	std::vector<TipStupca> tipovi;
+	std::vector<const void*> adrese;
+
+	uint8_t* komad = nullptr;
+	size_t velicinaKomada = 0;
+	uint32_t redUKomadu = 0;
+	uint64_t brRedova = 0, brKomada = 0;
+	std::vector<uint64_t> statistika;
+	bool zatvoreno = false;
+};
+
+/* Citanje stupcane datoteke iz mapirane memorije, bez kopiranja */
+class CitacStupaca
+{
+public:
+	explicit CitacStupaca(const std::string& ime) : mapa(ime)
+	{
+		if (mapa.Velicina() < STUP_STRANICA)
+			throw std::runtime_error(ime + " nije stupcana datoteka");
+		z = (const ZaglavljeStupaca*)mapa.Podaci();
+		if (std::memcmp(z->magija, "PI2S", 4) != 0)
+			throw std::runtime_error(ime + " nije stupcana datoteka");
+		if (z->oznaka != REZ_OZNAKA_PORETKA)
+			throw std::runtime_error("Stupcana datoteka je zapisana s drugim poretkom bajtova");
+		if (z->verzija != STUP_VERZIJA || z->brStupaca > STUP_MAX_STUPACA)
+			throw std::runtime_error("Nepoznata verzija stupcane datoteke");
+		velicinaKomada = (uint64_t)std::max<uint32_t>(1, z->brStupaca) * z->redovaPoKomadu * 8;
+		if (z->pomakStatistike + z->brKomada * z->brStupaca * 16 > mapa.Velicina() ||
+			STUP_STRANICA + z->brKomada * velicinaKomada > mapa.Velicina() ||
+			z->brRedova > z->brKomada * z->redovaPoKomadu)
+			throw std::runtime_error("Stupcana datoteka je skracena");
+	}
+
+	/* Provjerava samo oznaku na pocetku datoteke */
+	static bool JeStupcana(const std::string& ime)
+	{
+		std::ifstream d(ime, std::ios::binary);
+		char magija[4] = {};
+		d.read(magija, 4);
+		return d && std::memcmp(magija, "PI2S", 4) == 0;
+	}
+
+	uint64_t BrojRedova() const { return z->brRedova; }
+	uint64_t BrojKomada() const { return z->brKomada; }
+	uint32_t RedovaPoKomadu() const { return z->redovaPoKomadu; }
+	size_t BrojStupaca() const { return z->brStupaca; }
+	std::string ImeStupca(size_t s) const { return std::string(z->stupci[s].ime); }
+	TipStupca Tip(size_t s) const { return (TipStupca)z->stupci[s].tip; }
+
+	int IndeksStupca(const std::string& ime) const
+	{
+		for (size_t s = 0; s < z->brStupaca; s++)
+			if (ime == z->stupci[s].ime)
+				return (int)s;
+		return -1;
+	}
+
+	/* Broj valjanih redova u komadu k */
+	size_t RedovaUKomadu(uint64_t k) const
+	{
+		return (size_t)std::min<uint64_t>(z->redovaPoKomadu, z->brRedova - k * z->redovaPoKomadu);
+	}
+
+	/* Pocetak stupca s u komadu k, izravno u mapiranoj datoteci */
+	const void* Podaci(size_t s, uint64_t k) const
+	{
+		return mapa.Podaci() + STUP_STRANICA + k * velicinaKomada + s * (uint64_t)z->redovaPoKomadu * 8;
+	}
+
+	/* Najmanja i najveca vrijednost stupca s u komadu k, bez citanja podataka */
+	template <class T>
+	void MinMax(size_t s, uint64_t k, T& mn, T& mx) const
+	{
+		const uint8_t* p = mapa.Podaci() + z->pomakStatistike + (k * z->brStupaca + s) * 16;
+		std::memcpy(&mn, p, 8);
+		std::memcpy(&mx, p + 8, 8);
+	}
+
+private:
+	MapiranaDatoteka mapa;
+	const ZaglavljeStupaca* z = nullptr;
+	uint64_t velicinaKomada = 0;
+};
+
+/* Stupcana datoteka kao izvor podataka: raspon je komad, a vrijednost je pokazivac u mapiranu datoteku */
+class IzvorStupaca : public IzvorPodataka
+{
+public:
+	explicit IzvorStupaca(const std::string& ime) : citac(ime) {}
+
+	const CitacStupaca& Citac() const { return citac; }
+
+	std::vector<std::string> ImenaStupaca() const override
+	{
+		std::vector<std::string> imena;
+		for (size_t s = 0; s < citac.BrojStupaca(); s++)
+			imena.push_back(citac.ImeStupca(s));
+		return imena;
+	}
+
+	TipStupca Tip(const std::string& ime) const override { return citac.Tip(Indeks(ime)); }
+
+	void PostaviBrojUtora(unsigned brUtora) override
+	{
+		trenutni.assign(brUtora, std::vector<const void*>(citac.BrojStupaca(), nullptr));
+		komadUtora.assign(brUtora, 0);
+	}
+
+	const void* const* CitacStupca(const std::string& ime, unsigned utor) override { return &trenutni[utor][Indeks(ime)]; }
+
+	std::vector<std::pair<uint64_t, uint64_t>> RasponiRedova() const override
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> r;
+		for (uint64_t k = 0; k < citac.BrojKomada(); k++)
+			r.push_back({ k * citac.RedovaPoKomadu(), k * citac.RedovaPoKomadu() + citac.RedovaUKomadu(k) });
+		return r;
+	}
+
+	void PocniRaspon(unsigned utor, uint64_t od) override { komadUtora[utor] = od / citac.RedovaPoKomadu(); }
+
+	void PostaviRed(unsigned utor, uint64_t red) override
+	{
+		uint64_t k = komadUtora[utor], uKomadu = red - k * citac.RedovaPoKomadu();
+		for (size_t s = 0; s < trenutni[utor].size(); s++)
+			trenutni[utor][s] = (const uint8_t*)citac.Podaci(s, k) + uKomadu * 8;
+	}
+
+	/* Raspon je komad, a stupac komada je jedan niz */
+	size_t NajveciBlok() const override { return citac.RedovaPoKomadu(); }
+
+private:
+	size_t Indeks(const std::string& ime) const
+	{
+		int s = citac.IndeksStupca(ime);
+		if (s < 0)
+			throw std::runtime_error("Nema stupca " + ime);
+		return (size_t)s;
+	}
+
+	CitacStupaca citac;
+	std::vector<std::vector<const void*>> trenutni;
+	std::vector<uint64_t> komadUtora;
+};
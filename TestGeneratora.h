@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Statistika.h"
+
+/*
+	Baterija testova kvalitete generatora slucajnih brojeva (po uzoru na TestU01 SmallCrush):
+	frekvencija (chi^2, KS, AD), serijski parovi, praznine, rodjendanski razmaci
+	i 2D jednolikost na jedinicnom kvadratu koji koristi \pi test.
+	Brojevi se ne spremaju: svaka dretva ima svoj generator i svoje brojace, koji se na kraju zbrajaju.
+*/
+
+/* Isti LCG koji stoji iza rand() u MSVC-u (15 bita, RAND_MAX = 32767), ali s vlastitim stanjem po dretvi */
+struct MsvcRand
+{
+	typedef uint32_t result_type;
+	uint32_t stanje;
+	explicit MsvcRand(uint32_t sjeme = 1) : stanje(sjeme) {}
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return 0x7fff; }
+	result_type operator()()
+	{
+		stanje = stanje * 214013u + 2531011u;
+		return (stanje >> 16) & 0x7fff;
+	}
+};
+
+/* Broj iz [0,1) s punom razlucivosti generatora */
+template <class G>
+inline double Jednolik(G& g)
+{
+	const double raspon = (double)(g.max() - g.min()) + 1.0;
+	double u = (double)(g() - g.min()) / raspon;
+	return u < 1.0 ? u : std::nextafter(1.0, 0.0);
+}
+
+/* Broj punih bitova koje generator daje u jednom pozivu */
+template <class G>
+inline int BitaGeneratora()
+{
+	return (int)floor(log2((double)(G::max() - G::min()) + 1.0));
+}
+
+const int TG_FREK_BITA = 16;     /* najvise 2^16 pretinaca za frekvencijski test */
+const int TG_PAR = 64;           /* d x d mreza za serijske parove */
+const int TG_PRAZ = 16;          /* duljine praznina 0..15 i >= 16 */
+const int TG_RODJ_M = 512;       /* rodjendana po pokusu */
+const int TG_RODJ_BITA = 24;     /* godina od 2^24 dana, lambda = m^3 / (4n) = 2 */
+const int TG_RAD = 1024;         /* pretinci za r^2 tocaka u krugu */
+
+/*
+	Brojaci jednog generatora. Testovi ne smiju biti finiji od razlucivosti generatora (15-bitni
+	rand() inace puni samo svaki drugi pretinac i ima samo 2^15 razlicitih rodjendana), pa je
+	pretinaca frekvencije 2^min(16, bita), a rodjendan se slaze od bitova iz vise uzastopnih brojeva
+	(kao u TestU01), npr. 12 + 12 bita iz dva broja rand().
+*/
+struct BrojaciGeneratora
+{
+	uint64_t brBrojeva = 0, brParova = 0, uKrugu = 0;
+	std::vector<uint64_t> frek, par, praznine, radijus;
+	uint64_t rodjPokusa = 0, rodjDuplikata = 0;
+	int rodjDijelova = 1;
+
+	explicit BrojaciGeneratora(int bita = 64)
+		: frek(size_t(1) << std::min(TG_FREK_BITA, bita)), par(TG_PAR * TG_PAR), praznine(TG_PRAZ + 1), radijus(TG_RAD)
+	{
+		while (TG_RODJ_BITA % rodjDijelova || TG_RODJ_BITA / rodjDijelova > bita)
+			rodjDijelova++;
+	}
+
+	void Dodaj(const BrojaciGeneratora& b)
+	{
+		brBrojeva += b.brBrojeva;
+		brParova += b.brParova;
+		uKrugu += b.uKrugu;
+		rodjPokusa += b.rodjPokusa;
+		rodjDuplikata += b.rodjDuplikata;
+		for (size_t i = 0; i < frek.size(); i++)
+			frek[i] += b.frek[i];
+		for (size_t i = 0; i < par.size(); i++)
+			par[i] += b.par[i];
+		for (size_t i = 0; i < praznine.size(); i++)
+			praznine[i] += b.praznine[i];
+		for (size_t i = 0; i < radijus.size(); i++)
+			radijus[i] += b.radijus[i];
+	}
+};
+
+/* Jedna dretva: brBrojeva brojeva iz vlastitog generatora, bez spremanja */
+template <class G>
+void TestirajDio(G g, uint64_t brBrojeva, BrojaciGeneratora& b)
+{
+	const int brFrek = (int)b.frek.size();
+	const int bitaDijela = TG_RODJ_BITA / b.rodjDijelova;
+	std::vector<uint32_t> rodj;
+	rodj.reserve(TG_RODJ_M);
+	std::vector<uint32_t> razmaci(TG_RODJ_M);
+	uint32_t dan = 0;
+	int dijelova = 0;
+	uint64_t praznina = 0;
+	double x = 0.0;
+
+	for (uint64_t i = 0; i < brBrojeva; i++)
+	{
+		double u = Jednolik(g);
+		b.frek[(int)(u * brFrek)]++;
+
+		/* Praznine izmedju brojeva u [0, 1/2) */
+		if (u < 0.5)
+		{
+			b.praznine[std::min<uint64_t>(praznina, TG_PRAZ)]++;
+			praznina = 0;
+		}
+		else
+			praznina++;
+
+		/* Parovi (x,y) kao u \pi testu */
+		if (i & 1)
+		{
+			double y = u;
+			b.par[(int)(x * TG_PAR) * TG_PAR + (int)(y * TG_PAR)]++;
+			double r2 = x * x + y * y;
+			if (r2 <= 1.0)
+			{
+				b.uKrugu++;
+				b.radijus[std::min((int)(r2 * TG_RAD), TG_RAD - 1)]++;
+			}
+			b.brParova++;
+		}
+		else
+			x = u;
+
+		/* Rodjendanski razmaci (Marsaglia) */
+		dan = (dan << bitaDijela) | (uint32_t)(u * (1u << bitaDijela));
+		if (++dijelova == b.rodjDijelova)
+		{
+			rodj.push_back(dan);
+			dan = 0;
+			dijelova = 0;
+		}
+		if ((int)rodj.size() == TG_RODJ_M)
+		{
+			std::sort(rodj.begin(), rodj.end());
+			razmaci[0] = rodj[0];
+			for (int k = 1; k < TG_RODJ_M; k++)
+				razmaci[k] = rodj[k] - rodj[k - 1];
+			std::sort(razmaci.begin(), razmaci.end());
+			for (int k = 1; k < TG_RODJ_M; k++)
+				if (razmaci[k] == razmaci[k - 1])
+					b.rodjDuplikata++;
+			b.rodjPokusa++;
+			rodj.clear();
+		}
+	}
+	b.brBrojeva += brBrojeva;
+}
+
+struct RezultatTesta
+{
+	std::string ime;
+	double statistika, p;
+};
+
+/* Iz zbrojenih brojaca racuna statistike i p-vrijednosti */
+inline std::vector<RezultatTesta> OcijeniBrojace(const BrojaciGeneratora& b)
+{
+	std::vector<RezultatTesta> r;
+	double N = (double)b.brBrojeva;
+	const int brFrek = (int)b.frek.size();
+
+	/* Frekvencija: chi^2 po pretincima, KS i AD na rubovima/sredinama pretinaca */
+	double e = N / brFrek, chi2 = 0.0, D = 0.0, A2 = 0.0, kum = 0.0;
+	for (int k = 0; k < brFrek; k++)
+	{
+		double c = (double)b.frek[k];
+		chi2 += (c - e) * (c - e) / e;
+		double m = (k + 0.5) / brFrek;
+		double Fm = (kum + c / 2) / N;
+		A2 += (Fm - m) * (Fm - m) / (m * (1 - m)) / brFrek;
+		kum += c;
+		D = std::max(D, fabs(kum / N - (k + 1.0) / brFrek));
+	}
+	A2 *= N;
+	r.push_back({ "frekvencija chi2", chi2, Chi2PVrijednost(chi2, brFrek - 1) });
+	r.push_back({ "frekvencija KS", D, KolmogorovQ(sqrt(N) * D) });
+	r.push_back({ "frekvencija AD", A2, ADInfPVrijednost(A2) });
+
+	/* Serijski parovi u d x d mrezi */
+	double P = (double)b.brParova;
+	e = P / (TG_PAR * TG_PAR);
+	chi2 = 0.0;
+	for (uint64_t c : b.par)
+		chi2 += ((double)c - e) * ((double)c - e) / e;
+	r.push_back({ "serijski parovi", chi2, Chi2PVrijednost(chi2, TG_PAR * TG_PAR - 1) });
+
+	/* Praznine: P(r) = p (1-p)^r, P(>= t) = (1-p)^t, p = 1/2 */
+	double brPraz = 0.0;
+	for (uint64_t c : b.praznine)
+		brPraz += (double)c;
+	chi2 = 0.0;
+	for (int k = 0; k <= TG_PRAZ; k++)
+	{
+		double pk = k < TG_PRAZ ? 0.5 * pow(0.5, k) : pow(0.5, TG_PRAZ);
+		double ek = brPraz * pk;
+		chi2 += ((double)b.praznine[k] - ek) * ((double)b.praznine[k] - ek) / ek;
+	}
+	r.push_back({ "praznine", chi2, Chi2PVrijednost(chi2, TG_PRAZ) });
+
+	/* Rodjendanski razmaci: ukupan broj ponovljenih razmaka ~ Poisson(lambda * pokusa) */
+	double lambda = pow((double)TG_RODJ_M, 3) / (4.0 * pow(2.0, TG_RODJ_BITA));
+	r.push_back({ "rodjendanski razmaci", (double)b.rodjDuplikata,
+		b.rodjPokusa ? PoissonPVrijednost((double)b.rodjDuplikata, lambda * b.rodjPokusa) : 1.0 });
+
+	/* 2D: udio tocaka u krugu (\pi/4) i jednolikost r^2 unutar kruga */
+	double pk = 3.14159265358979323846 / 4;
+	double z = ((double)b.uKrugu - P * pk) / sqrt(P * pk * (1 - pk));
+	r.push_back({ "2D udio u krugu (z)", z, erfc(fabs(z) / sqrt(2.0)) });
+	e = (double)b.uKrugu / TG_RAD;
+	chi2 = 0.0;
+	for (uint64_t c : b.radijus)
+		chi2 += ((double)c - e) * ((double)c - e) / e;
+	r.push_back({ "2D r^2 u krugu", chi2, Chi2PVrijednost(chi2, TG_RAD - 1) });
+	return r;
+}
+
+/* Cijela baterija za jedan generator, brBrojeva podijeljeno na brDretvi dretvi */
+template <class G>
+std::vector<RezultatTesta> TestirajGenerator(uint64_t brBrojeva, unsigned brDretvi, uint32_t sjeme)
+{
+	std::vector<BrojaciGeneratora> brojaci(brDretvi, BrojaciGeneratora(BitaGeneratora<G>()));
+	std::vector<std::thread> dretve;
+	for (unsigned t = 0; t < brDretvi; t++)
+	{
+		uint64_t dio = brBrojeva / brDretvi + (t < brBrojeva % brDretvi ? 1 : 0);
+		std::seed_seq ss{ sjeme, t };
+		uint32_t s[1];
+		ss.generate(s, s + 1);
+		dretve.emplace_back(TestirajDio<G>, G(s[0]), dio, std::ref(brojaci[t]));
+	}
+	for (auto& d : dretve)
+		d.join();
+	for (unsigned t = 1; t < brDretvi; t++)
+		brojaci[0].Dodaj(brojaci[t]);
+	return OcijeniBrojace(brojaci[0]);
+}
+
+inline void IspisiRezultate(const std::string& ime, const std::vector<RezultatTesta>& r)
+{
+	std::cout << "Generator " << ime << ":" << std::endl;
+	for (const auto& t : r)
+		std::cout << "  " << std::left << std::setw(24) << t.ime << std::right << std::setw(18) << t.statistika
+			<< "  p = " << t.p << (t.p < 0.001 ? "  <-- PAD" : "") << std::endl;
+}
+
+/* Svi generatori koje sampler moze koristiti, 10^potencija brojeva po generatoru */
+inline void TestirajGeneratore(int potencija, uint32_t sjeme)
+{
+	uint64_t brBrojeva = (uint64_t)pow(10, potencija);
+	unsigned brDretvi = std::max(1u, std::thread::hardware_concurrency());
+	IspisiRezultate("rand() (MSVC LCG)", TestirajGenerator<MsvcRand>(brBrojeva, brDretvi, sjeme));
+	IspisiRezultate("minstd_rand", TestirajGenerator<std::minstd_rand>(brBrojeva, brDretvi, sjeme));
+	IspisiRezultate("mt19937", TestirajGenerator<std::mt19937>(brBrojeva, brDretvi, sjeme));
+	IspisiRezultate("mt19937_64", TestirajGenerator<std::mt19937_64>(brBrojeva, brDretvi, sjeme));
+	IspisiRezultate("ranlux48", TestirajGenerator<std::ranlux48>(brBrojeva, brDretvi, sjeme));
+}
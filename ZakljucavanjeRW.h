@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "SkupInstrukcija.h"
+
+/* Kratko cekanje u petlji; nakon mnogo pokusaja dretva prepusta procesor */
+inline void Pauza(unsigned& pokusaj)
+{
+	if (++pokusaj < 64)
+	{
+#ifdef PI2TEST_X86
+		_mm_pause();
+#endif
+	}
+	else
+		std::this_thread::yield();
+}
+
+/*
+	Zakljucavanje citatelj/pisac s vrtnjom na jednom atomskom brojacu (-1 pisac, inace broj citatelja).
+	Jednostavno, ali svaki citatelj pise u istu liniju prirucne memorije, pa pri mnogo jezgri
+	citanje postaje skupo iako citatelji jedan drugoga ne iskljucuju.
+*/
+class SpinRW
+{
+public:
+	void lock_shared()
+	{
+		unsigned pokusaj = 0;
+		for (;;)
+		{
+			int s = stanje.load(std::memory_order_relaxed);
+			if (s >= 0 && stanje.compare_exchange_weak(s, s + 1, std::memory_order_acquire))
+				return;
+			Pauza(pokusaj);
+		}
+	}
+
+	void unlock_shared() { stanje.fetch_sub(1, std::memory_order_release); }
+
+	void lock()
+	{
+		unsigned pokusaj = 0;
+		for (;;)
+		{
+			int s = 0;
+			if (stanje.compare_exchange_weak(s, -1, std::memory_order_acquire))
+				return;
+			Pauza(pokusaj);
+		}
+	}
+
+	void unlock() { stanje.store(0, std::memory_order_release); }
+
+private:
+	std::atomic<int> stanje{ 0 };
+};
+
+/*
+	Zakljucavanje citatelj/pisac s brojacem citatelja po utoru ("big-reader"): dretva broji svoje
+	citanje u svom utoru (svaki u svojoj liniji prirucne memorije) i samo procita zastavicu pisca,
+	koja se mijenja rijetko. Citanje zato ne ovisi o broju jezgri. Pisac postavi zastavicu i ceka
+	da se isprazne svi utori, pa je pisanje skuplje i raste s brojem utora; namijenjeno je za
+	podatke koji se gotovo samo citaju.
+
+	Kao ni std::shared_mutex, citanje se ne smije ugnijezditi (citatelj bi cekao pisca koji ceka
+	njega), a pisce redom pusta mutex. Dretve se utorima dodjeljuju redom, pa utor dijeli vise
+	dretvi tek kad ih je vise nego utora. Redoslijed je seq_cst s obje strane: citatelj poveca
+	utor pa procita zastavicu, pisac postavi zastavicu pa procita utore, i barem jedan od njih
+	vidi drugoga.
+*/
+class RaspodijeljeniRW
+{
+public:
+	/* brUtora = 0: broj procesora */
+	explicit RaspodijeljeniRW(unsigned brUtora = 0)
+	{
+		if (brUtora == 0)
+			brUtora = std::max(1u, std::thread::hardware_concurrency());
+		this->brUtora = brUtora;
+		utori.reset(new Utor[brUtora]);
+	}
+
+	RaspodijeljeniRW(const RaspodijeljeniRW&) = delete;
+	RaspodijeljeniRW& operator=(const RaspodijeljeniRW&) = delete;
+
+	void lock_shared()
+	{
+		std::atomic<int>& u = utori[IndeksDretve() % brUtora].citatelja;
+		unsigned pokusaj = 0;
+		for (;;)
+		{
+			u.fetch_add(1, std::memory_order_seq_cst);
+			if (!pisac.load(std::memory_order_seq_cst))
+				return;
+			/* Pisac ceka ili pise: povuci se dok ne zavrsi */
+			u.fetch_sub(1, std::memory_order_relaxed);
+			while (pisac.load(std::memory_order_relaxed))
+				Pauza(pokusaj);
+		}
+	}
+
+	void unlock_shared() { utori[IndeksDretve() % brUtora].citatelja.fetch_sub(1, std::memory_order_release); }
+
+	void lock()
+	{
+		pisci.lock();
+		pisac.store(true, std::memory_order_seq_cst);
+		for (unsigned i = 0; i < brUtora; i++)
+		{
+			unsigned pokusaj = 0;
+			while (utori[i].citatelja.load(std::memory_order_seq_cst) != 0)
+				Pauza(pokusaj);
+		}
+	}
+
+	void unlock()
+	{
+		pisac.store(false, std::memory_order_release);
+		pisci.unlock();
+	}
+
+	unsigned BrojUtora() const { return brUtora; }
+
+private:
+	struct alignas(64) Utor
+	{
+		std::atomic<int> citatelja{ 0 };
+	};
+
+	static unsigned IndeksDretve()
+	{
+		static std::atomic<unsigned> sljedeci{ 0 };
+		static thread_local unsigned indeks = sljedeci.fetch_add(1, std::memory_order_relaxed);
+		return indeks;
+	}
+
+	unsigned brUtora;
+	std::unique_ptr<Utor[]> utori;
+	alignas(64) std::atomic<bool> pisac{ false };
+	std::mutex pisci;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "SkupInstrukcija.h"
+
+/*
+	Obrtanje poretka bajtova za nizove 2, 4 i 8-bajtnih vrijednosti.
+	Na x86 se 16 (SSSE3 pshufb) ili 32 bajta (AVX2 vpshufb) obrce jednom instrukcijom s maskom
+	koja unutar svake vrijednosti okrece bajtove; ostatak niza ide skalarno. Skup instrukcija se
+	bira pri izvodjenju (CPUID), pa isti program radi i na procesorima bez AVX2.
+*/
+
+/* Obrnuti poredak bajtova jedne vrijednosti */
+template <class T>
+T ObrniBajtove(T v)
+{
+	uint8_t b[sizeof(T)];
+	std::memcpy(b, &v, sizeof(T));
+	std::reverse(b, b + sizeof(T));
+	std::memcpy(&v, b, sizeof(T));
+	return v;
+}
+
+/* Skalarno obrtanje n vrijednosti sirine w na mjestu; pomaci su oblika koji prevoditelj pretvara u bswap */
+inline void ObrniSkalarno(uint8_t* p, size_t n, size_t w)
+{
+	for (size_t i = 0; i < n; i++, p += w)
+	{
+		if (w == 8)
+		{
+			uint64_t v;
+			std::memcpy(&v, p, 8);
+			v = (v >> 56) | ((v >> 40) & 0xFF00) | ((v >> 24) & 0xFF0000) | ((v >> 8) & 0xFF000000) |
+				((v & 0xFF000000) << 8) | ((v & 0xFF0000) << 24) | ((v & 0xFF00) << 40) | (v << 56);
+			std::memcpy(p, &v, 8);
+		}
+		else if (w == 4)
+		{
+			uint32_t v;
+			std::memcpy(&v, p, 4);
+			v = (v >> 24) | ((v >> 8) & 0xFF00) | ((v & 0xFF00) << 8) | (v << 24);
+			std::memcpy(p, &v, 4);
+		}
+		else if (w == 2)
+		{
+			uint16_t v;
+			std::memcpy(&v, p, 2);
+			v = (uint16_t)((v >> 8) | (v << 8));
+			std::memcpy(p, &v, 2);
+		}
+	}
+}
+
+#ifdef PI2TEST_X86
+/* Maska za pshufb: bajt i ide na mjesto (i/w)*w + (w-1-i%w) */
+inline void MaskaObrtanja(uint8_t* maska, size_t w)
+{
+	for (size_t i = 0; i < 16; i++)
+		maska[i] = (uint8_t)((i / w) * w + (w - 1 - i % w));
+}
+
+PI2TEST_CILJ("ssse3")
+inline void ObrniSSSE3(uint8_t* p, size_t n, size_t w)
+{
+	uint8_t m[16];
+	MaskaObrtanja(m, w);
+	const __m128i maska = _mm_loadu_si128((const __m128i*)m);
+	size_t bajtova = n * w, i = 0;
+	for (; i + 16 <= bajtova; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		_mm_storeu_si128((__m128i*)(p + i), _mm_shuffle_epi8(v, maska));
+	}
+	ObrniSkalarno(p + i, (bajtova - i) / w, w);
+}
+
+/* vpshufb radi unutar 128-bitnih polovica, pa je ista maska u obje; dva registra po koraku */
+PI2TEST_CILJ("avx2")
+inline void ObrniAVX2(uint8_t* p, size_t n, size_t w)
+{
+	uint8_t m[16];
+	MaskaObrtanja(m, w);
+	const __m256i maska = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)m));
+	size_t bajtova = n * w, i = 0;
+	for (; i + 64 <= bajtova; i += 64)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(p + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(p + i + 32));
+		_mm256_storeu_si256((__m256i*)(p + i), _mm256_shuffle_epi8(a, maska));
+		_mm256_storeu_si256((__m256i*)(p + i + 32), _mm256_shuffle_epi8(b, maska));
+	}
+	for (; i + 32 <= bajtova; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(p + i));
+		_mm256_storeu_si256((__m256i*)(p + i), _mm256_shuffle_epi8(a, maska));
+	}
+	ObrniSkalarno(p + i, (bajtova - i) / w, w);
+}
+#endif
+
+/*
+	Obrce n vrijednosti sirine w (2, 4 ili 8 bajtova) na mjestu zadanim skupom instrukcija.
+	Skup koji procesor ne podrzava ne smije se traziti; bez zadanog skupa uzima se najbolji.
+*/
+inline void ObrniBajtoveNiza(void* podaci, size_t n, size_t w, SkupInstrukcija skup)
+{
+	uint8_t* p = (uint8_t*)podaci;
+	if (w < 2)
+		return;
+#ifdef PI2TEST_X86
+	if (skup == SkupInstrukcija::AVX2)
+	{
+		ObrniAVX2(p, n, w);
+		return;
+	}
+	if (skup == SkupInstrukcija::SSSE3)
+	{
+		ObrniSSSE3(p, n, w);
+		return;
+	}
+#else
+	(void)skup;
+#endif
+	ObrniSkalarno(p, n, w);
+}
+
+inline void ObrniBajtoveNiza(void* podaci, size_t n, size_t w)
+{
+	ObrniBajtoveNiza(podaci, n, w, NajboljiSkupInstrukcija());
+}